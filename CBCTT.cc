@@ -1,18 +1,294 @@
 #include "CBCTT.hh"
+#include <climits>
+#include <cstdlib>
 
 void LNSCBCTT::neighborhood_branching()
 {
-    // Post branching rules 
-    branch(*this, roomslot, INT_VAR_DEGREE_MAX(), INT_VAL_MIN());
+    IntValBranch values = neighborhood_values == NB_VAL_GUIDED ? INT_VAL(&LNSCBCTT::guided_value) : INT_VAL_MIN();
+    
+    // Post branching rules (AFC and activity decay slowly, so that they carry over the LNS iterations)
+    switch (neighborhood_variables)
+    {
+        case NB_VAR_AFC:
+            branch(*this, roomslot, INT_VAR_AFC_MAX(0.99), values);
+            break;
+        case NB_VAR_ACTIVITY:
+            branch(*this, roomslot, INT_VAR_ACTIVITY_MAX(activity), values);
+            break;
+        case NB_VAR_DEGREE:
+        default:
+            branch(*this, roomslot, INT_VAR_DEGREE_MAX(), values);
+            break;
+    }
+}
+
+void LNSCBCTT::post_perturbation(const CBCTTOptions& o)
+{
+    Faculty old_in(o.oldInstance());
+    Perturbation p(old_in, o.oldSolution(), in, o.perturbationRadius());
+    
+    reference = SharedArray<int>(roomslot.size());
+    BoolVarArgs moved;
+    vector<int> freed;
+    for (int l = 0; l < roomslot.size(); l++)
+    {
+        reference[l] = p.roomslots()[l];
+        if (!p.freed()[l])
+            rel(*this, roomslot[l] == reference[l]);
+        else
+        {
+            freed.push_back(l);
+            if (reference[l] >= 0)
+                moved << expr(*this, roomslot[l] != reference[l]);
+        }
+    }
+    perturbation = expr(*this, sum(moved));
+    z = expr(*this, z + (int) o.perturbationWeight() * perturbation);
+    
+    // Only the re-scheduled lectures are relaxed (and count for the intensities of the LNS)
+    relaxable = SharedArray<int>(freed.size());
+    for (unsigned int i = 0; i < freed.size(); i++)
+        relaxable[i] = freed[i];
+    
+    if (debug)
+        cerr << "Re-solve: " << p.invalidated() << " lectures invalidated by the edit, " << freed.size() << " of " << roomslot.size() << " lectures re-scheduled" << endl;
+}
+
+void LNSCBCTT::neighborhood_strategy(unsigned int s)
+{
+    switch (s)
+    {
+        case 1:
+            branch(*this, roomslot, INT_VAR_DEGREE_MAX(), INT_VAL_MIN());
+            break;
+        case 2:
+            branch(*this, roomslot, INT_VAR_AFC_MAX(0.99), INT_VAL(&LNSCBCTT::guided_value));
+            break;
+        case 3:
+            branch(*this, roomslot, INT_VAR_ACTIVITY_MAX(activity), INT_VAL(&LNSCBCTT::guided_value));
+            break;
+        case 4:
+        {
+            Rnd r(Random::Int(0, UINT_MAX));
+            branch(*this, roomslot, INT_VAR_RND(r), INT_VAL_RND(r));
+            break;
+        }
+        case 0:
+        default:
+            neighborhood_branching();
+            break;
+    }
+}
+
+const char* LNSCBCTT::neighborhood_strategy_name(unsigned int s) const
+{
+    static const char* names[] = { "default", "degree/min", "afc/guided", "activity/guided", "random" };
+    return s < 5 ? names[s] : "unknown";
+}
+
+int LNSCBCTT::guided_value(const Space& home, IntVar x, int i)
+{
+    const LNSCBCTT& s = static_cast<const LNSCBCTT&>(home);
+    if (s.guide.size() == 0)
+        return x.min();
+    int g = s.guide[i];
+    if (x.in(g))
+        return g;
+    
+    // Closest roomslot, moving to another room in the same period costs less than moving to another period
+    int rooms = in.Rooms(), closest = x.min(), closest_distance = INT_MAX;
+    for (IntVarValues v(x); v(); ++v)
+    {
+        int d = 2 * abs(v.val() / rooms - g / rooms) + (v.val() % rooms != g % rooms);
+        if (d < closest_distance)
+        {
+            closest = v.val();
+            closest_distance = d;
+        }
+    }
+    return closest;
 }
 
 
 
 void LNSCBCTT::initial_solution_branching(unsigned long int restarts)
 {
-    // Post branching rules
-    branch(*this, roomslot, INT_VAR_RND(restarts), INT_VAL_RND(restarts));
+    LNS_PROFILE_SCOPE(Search::Meta::LNS_PHASE_CONSTRUCTION);
+    
+    // Solution to start from (only at the first search, restarts start over)
+    vector<int> init;
+    if (options->init() != NULL && restarts == 0)
+        init = read_solution(in, options->init());
+    else if (reference.size() > 0 && restarts == 0)
+        for (int l = 0; l < reference.size(); l++)
+            init.push_back(reference[l]);
+    
+    if (!init.empty() || options->construction() != CONSTRUCTION_RANDOM)
+    {
+        vector<int> timetable;
+        if (options->construction() != CONSTRUCTION_RANDOM)
+        {
+            Construction construction(in);
+            timetable = construction.build(options->construction() == CONSTRUCTION_TABUCOL ? options->tabuIterations() : 0);
+            if (debug)
+                cerr << "Construction: " << construction.violations() << " hard violations" << endl;
+        }
+        
+        // Follow the solution file, then the greedy (and possibly repaired) timetable; lectures which cannot
+        // be placed there are moved to the closest available roomslot, lectures in neither are placed at random
+        IntVarArgs guided, unguided;
+        vector<int> values;
+        for (int l = 0; l < roomslot.size(); l++)
+        {
+            int v = !init.empty() && init[l] >= 0 ? init[l] : (!timetable.empty() ? timetable[l] : -1);
+            if (v >= 0)
+            {
+                guided << roomslot[l];
+                values.push_back(v);
+            }
+            else
+                unguided << roomslot[l];
+        }
+        guide = SharedArray<int>(values.size());
+        for (unsigned int i = 0; i < values.size(); i++)
+            guide[i] = values[i];
+        branch(*this, guided, INT_VAR_NONE(), INT_VAL(&LNSCBCTT::guided_value));
+        if (unguided.size() > 0)
+        {
+            Rnd r(Random::Int(0, UINT_MAX));
+            branch(*this, unguided, INT_VAR_RND(r), INT_VAL_RND(r));
+        }
+        return;
+    }
+    
+    // Post branching rules (the seed is drawn from the stream of the calling engine)
+    Rnd r(Random::Int(0, UINT_MAX));
+    branch(*this, roomslot, INT_VAR_RND(r), INT_VAL_RND(r));
+}
+
+unsigned int LNSCBCTT::local_search(Space* tentative_s)
+{
+    LNSCBCTT* tentative = static_cast<LNSCBCTT*>(tentative_s);
+    vector<unsigned int> periods(roomslot.size()), rooms(roomslot.size());
+    for (int l = 0; l < roomslot.size(); l++)
+    {
+        periods[l] = roomslot[l].val() / in.Rooms();
+        rooms[l] = roomslot[l].val() % in.Rooms();
+    }
+    
+    // When re-solving, only the re-scheduled lectures can move, and moving them costs the perturbation
+    KempeSearch search(in);
+    if (reference.size() > 0)
+    {
+        vector<bool> fixed(roomslot.size(), true);
+        for (int i = 0; i < relaxable.size(); i++)
+            fixed[relaxable[i]] = false;
+        vector<int> old(reference.size());
+        for (int l = 0; l < reference.size(); l++)
+            old[l] = reference[l];
+        search.fix(fixed);
+        search.perturbation(old, options->perturbationWeight());
+    }
+    unsigned int moved = search.run(periods, rooms, options->kempeMoves());
+    if (moved == 0)
+        return 0;
+    
+    // The other lectures are already fixed in the root space
+    for (int i = 0; i < relaxable.size(); i++)
+    {
+        int l = relaxable[i];
+        rel(*tentative, tentative->roomslot[l] == (int) (periods[l] * in.Rooms() + rooms[l]));
+    }
+    return moved;
 }
 
+unsigned int LNSCBCTT::relax_propagation_guided(Space* tentative_s, unsigned int free)
+{
+    LNSCBCTT* tentative = static_cast<LNSCBCTT*>(tentative_s);
+    // Only the relaxable lectures are released (the other ones are fixed in the root space)
+    unsigned int lectures = roomslot.size(), relaxables = relaxable.size();
+    
+    if (free >= relaxables)
+        return relaxables;
+    
+    // Scratch copy of the (yet unconstrained) neighbor, restricted to the solutions of the
+    // model that satisfy the hard constraints and do not worsen the incumbent, so that
+    // fixing a lecture propagates onto the lectures which are actually coupled with it
+    LNS_PROFILE_SCOPE(Search::Meta::LNS_PHASE_RELAX_PROPAGATION);
+    LNSCBCTT* scratch = static_cast<LNSCBCTT*>(tentative->clone());
+    scratch->constrain(*this, false, 0.0);
+    
+    // Domain sizes of each lecture (on roomslots and periods) before the last fixing
+    vector<unsigned int> roomslot_size(lectures), period_size(lectures);
+    vector<double> affinity(lectures, 0.0);
+    vector<bool> released(lectures, false);
+    
+    bool consistent = scratch->status() != SS_FAILED;
+    if (consistent)
+        for (unsigned int l = 0; l < lectures; l++)
+        {
+            roomslot_size[l] = scratch->roomslot[l].size();
+            period_size[l] = scratch->period[l].size();
+        }
+    
+    // Seed lecture
+    unsigned int next = relaxable[Random::Int(0, relaxables - 1)], freed = 0;
+    
+    while (true)
+    {
+        released[next] = true;
+        freed++;
+        
+        if (freed >= free)
+            break;
+        
+        // Fix the released lecture to its incumbent value and see where propagation goes
+        if (consistent)
+        {
+            rel(*scratch, scratch->roomslot[next] == roomslot[next].val());
+            consistent = scratch->status() != SS_FAILED;
+        }
+        
+        // Next lecture to release is the one which was most affected (so far) by propagation
+        next = lectures;
+        double most_affected = 0.0;
+        for (unsigned int i = 0; consistent && i < relaxables; i++)
+        {
+            unsigned int l = relaxable[i];
+            if (released[l])
+                continue;
+            
+            unsigned int rs = scratch->roomslot[l].size(), ps = scratch->period[l].size();
+            affinity[l] += log((double) roomslot_size[l] / rs) + log((double) period_size[l] / ps);
+            roomslot_size[l] = rs;
+            period_size[l] = ps;
+            
+            if (affinity[l] > most_affected)
+            {
+                most_affected = affinity[l];
+                next = l;
+            }
+        }
+        
+        // No lecture is coupled with the released ones, pick another seed at random
+        if (next == lectures)
+        {
+            vector<unsigned int> candidates;
+            for (unsigned int i = 0; i < relaxables; i++)
+                if (!released[relaxable[i]])
+                    candidates.push_back(relaxable[i]);
+            next = candidates[Random::Int(0, candidates.size() - 1)];
+        }
+    }
+    
+    delete scratch;
+    
+    // Fix all the other lectures to their incumbent value
+    for (unsigned int i = 0; i < relaxables; i++)
+        if (!released[relaxable[i]])
+            rel(*tentative, tentative->roomslot[relaxable[i]] == roomslot[relaxable[i]].val());
+    
+    return freed;
+}
 
 Faculty CBCTT::in;
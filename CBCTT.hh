@@ -8,8 +8,12 @@
 #include <gecode/gist.hh>
 #include "faculty.hh"
 #include "gecode-lns/lns_space.h"
-#include "gecode-lns/meta_lns.h"
+#include "gecode-lns/lns.h"
 #include "branching.hh"
+#include "random.hh"
+#include "construction.hh"
+#include "local_search.hh"
+#include "solution.hh"
 #include <queue>
 #include <cmath>
 #include <map>
@@ -29,14 +33,155 @@
 
 #define pass
 
-#define ROOM_CAPACITY_COST 1            // per standing student
-#define MINIMUM_WORKING_DAYS_COST 5     // per day below minimum
-#define CURRICULUM_COMPACTNESS_COST 2   // per non-adjacent lectures in same day
-#define ROOM_STABILITY_COST 1           // per extra room used for the lectures of a course
+#include "costs.hh"
 
 using namespace Gecode;
 using namespace std;
 
+/** Relaxation operators available to the LNS */
+enum RelaxationType
+{
+    RELAX_HEURISTIC,            // cost-component driven heuristics
+    RELAX_PROPAGATION_GUIDED,   // propagation-guided (Perron et al., 2004)
+    RELAX_MIXED                 // pick one of the above at random at each iteration
+};
+
+/** Variable selection in neighborhood sub-searches */
+enum NeighborhoodVariableType
+{
+    NB_VAR_DEGREE,              // largest degree first
+    NB_VAR_AFC,                 // largest accumulated failure count first (accumulated over the LNS iterations)
+    NB_VAR_ACTIVITY             // largest activity first (accumulated over the LNS iterations)
+};
+
+/** Value selection in neighborhood sub-searches */
+enum NeighborhoodValueType
+{
+    NB_VAL_MIN,                 // smallest roomslot first
+    NB_VAL_GUIDED               // roomslot in the current solution (or the closest one) first
+};
+
+/** Construction of the initial solution */
+enum ConstructionType
+{
+    CONSTRUCTION_RANDOM,        // CP search with random variable and value selection
+    CONSTRUCTION_DSATUR,        // CP search following a greedy DSatur-style timetable (see construction.hh)
+    CONSTRUCTION_TABUCOL        // as above, the periods being repaired by tabu search until feasible (see feasibility.hh)
+};
+
+/** Families of constraints posted by the model, whose propagation can be profiled (see profile.hh) */
+enum ConstraintFamily
+{
+    FAMILY_CHANNELING,          // periods, timeslots, days and rooms from roomslots (always posted)
+    FAMILY_DUPLICATES,          // lectures in the same roomslot
+    FAMILY_ORDERING,            // lectures of a course in increasing periods (and redundant roomslot, day and timeslot orderings)
+    FAMILY_CONFLICTS,           // lectures of conflicting courses in the same period
+    FAMILY_CONFLICTING_LECTURES,// conflicting lectures of each lecture (for the relaxation)
+    FAMILY_AVAILABILITY,        // unavailable periods of the courses
+    FAMILY_CAPACITY,            // room capacity cost
+    FAMILY_STABILITY,           // room stability cost
+    FAMILY_WORKING_DAYS,        // minimum working days cost
+    FAMILY_COMPACTNESS,         // curriculum compactness cost (set constraints)
+    FAMILIES
+};
+
+/** Options of the CB-CTT solver (LNS options plus model specific ones) */
+class CBCTTOptions : public LNSInstanceOptions
+{
+public:
+
+    CBCTTOptions(const char* p) : LNSInstanceOptions(p),
+    _relaxation("-relaxation", "relaxation operator (default: heuristic, other values: pg, mixed)", RELAX_HEURISTIC),
+    _neighborhood_variables("-neighborhood_variables", "variable selection in neighborhoods (default: degree, other values: afc, activity)", NB_VAR_DEGREE),
+    _neighborhood_values("-neighborhood_values", "value selection in neighborhoods (default: min, other values: guided)", NB_VAL_MIN),
+    _construction("-construction", "construction of the initial solution (default: random, other values: dsatur, tabucol)", CONSTRUCTION_RANDOM),
+    _tabu_iterations("-tabu_iterations", "maximum number of iterations of the tabu search of the construction", 100000),
+    _kempe_moves("-kempe_moves", "number of Kempe chain and period swap moves tried by each run of the local search (see -lns_local_search)", 200),
+    _init("-init", "solution file (possibly partial or infeasible) the initial solution is built from"),
+    _old_instance("-old_instance", "instance the timetable of -old_solution was made for (re-solve with minimal perturbation)"),
+    _old_solution("-old_solution", "timetable to be perturbed as little as possible (re-solve with minimal perturbation)"),
+    _perturbation_weight("-perturbation_weight", "cost of each lecture moved from its roomslot in -old_solution", 1),
+    _perturbation_radius("-perturbation_radius", "distance (in the conflict graph of the courses) from the courses invalidated by the edit within which courses are re-scheduled", 0),
+    _propagation_profile("-propagation_profile", "profile the propagation of each family of constraints on this number of neighbors, instead of solving (0: no profiling)", 0)
+    {
+        _relaxation.add(RELAX_HEURISTIC, "heuristic");
+        _relaxation.add(RELAX_PROPAGATION_GUIDED, "pg");
+        _relaxation.add(RELAX_MIXED, "mixed");
+        _neighborhood_variables.add(NB_VAR_DEGREE, "degree");
+        _neighborhood_variables.add(NB_VAR_AFC, "afc");
+        _neighborhood_variables.add(NB_VAR_ACTIVITY, "activity");
+        _neighborhood_values.add(NB_VAL_MIN, "min");
+        _neighborhood_values.add(NB_VAL_GUIDED, "guided");
+        _construction.add(CONSTRUCTION_RANDOM, "random");
+        _construction.add(CONSTRUCTION_DSATUR, "dsatur");
+        _construction.add(CONSTRUCTION_TABUCOL, "tabucol");
+
+        add(_relaxation);
+        add(_neighborhood_variables);
+        add(_neighborhood_values);
+        add(_construction);
+        add(_tabu_iterations);
+        add(_kempe_moves);
+        add(_init);
+        add(_old_instance);
+        add(_old_solution);
+        add(_perturbation_weight);
+        add(_perturbation_radius);
+        add(_propagation_profile);
+    }
+
+    RelaxationType relaxation(void) const { return static_cast<RelaxationType>(_relaxation.value()); }
+    void relaxation(RelaxationType v) { _relaxation.value(v); }
+
+    NeighborhoodVariableType neighborhoodVariables(void) const { return static_cast<NeighborhoodVariableType>(_neighborhood_variables.value()); }
+    void neighborhoodVariables(NeighborhoodVariableType v) { _neighborhood_variables.value(v); }
+
+    NeighborhoodValueType neighborhoodValues(void) const { return static_cast<NeighborhoodValueType>(_neighborhood_values.value()); }
+    void neighborhoodValues(NeighborhoodValueType v) { _neighborhood_values.value(v); }
+
+    ConstructionType construction(void) const { return static_cast<ConstructionType>(_construction.value()); }
+    void construction(ConstructionType v) { _construction.value(v); }
+
+    unsigned int tabuIterations(void) const { return _tabu_iterations.value(); }
+    void tabuIterations(unsigned int v) { _tabu_iterations.value(v); }
+
+    unsigned int kempeMoves(void) const { return _kempe_moves.value(); }
+    void kempeMoves(unsigned int v) { _kempe_moves.value(v); }
+
+    const char* init(void) const { return _init.value(); }
+    void init(const char* v) { _init.value(v); }
+
+    const char* oldInstance(void) const { return _old_instance.value(); }
+    void oldInstance(const char* v) { _old_instance.value(v); }
+
+    const char* oldSolution(void) const { return _old_solution.value(); }
+    void oldSolution(const char* v) { _old_solution.value(v); }
+
+    unsigned int perturbationWeight(void) const { return _perturbation_weight.value(); }
+    void perturbationWeight(unsigned int v) { _perturbation_weight.value(v); }
+
+    unsigned int perturbationRadius(void) const { return _perturbation_radius.value(); }
+    void perturbationRadius(unsigned int v) { _perturbation_radius.value(v); }
+
+    unsigned int propagationProfile(void) const { return _propagation_profile.value(); }
+    void propagationProfile(unsigned int v) { _propagation_profile.value(v); }
+
+protected:
+
+    Driver::StringOption _relaxation;
+    Driver::StringOption _neighborhood_variables;
+    Driver::StringOption _neighborhood_values;
+    Driver::StringOption _construction;
+    Driver::UnsignedIntOption _tabu_iterations;
+    Driver::UnsignedIntOption _kempe_moves;
+    Driver::StringValueOption _init;
+    Driver::StringValueOption _old_instance;
+    Driver::StringValueOption _old_solution;
+    Driver::UnsignedIntOption _perturbation_weight;
+    Driver::UnsignedIntOption _perturbation_radius;
+    Driver::UnsignedIntOption _propagation_profile;
+};
+
 /** CP model for the Course-Based Curriculum Time Tabling Problem */
 class CBCTT : public DeferredBranchingSpace<MinimizeScript>
 {
@@ -107,13 +252,18 @@ protected:
 
 public:
 
+    /** Number of propagators posted by each family of constraints (only in the root space) */
+    vector<unsigned int> family_propagators;
+
     /** Constructor. 
      *  @param o instance options (e.g. instance name)
+     *  @param omitted families of constraints not to post (a bit for each ConstraintFamily), for profiling their propagation
+     *  @param faculty instance already read (e.g., by a program embedding the solver), instead of the one of the options
      */
-    CBCTT(const InstanceOptions& o) : debug(o.model() == 0)
+    CBCTT(const InstanceOptions& o, unsigned int omitted = 0, const Faculty* faculty = NULL) : debug(o.model() == 0)
     {
 
-	    CBCTT::in = Faculty(o.instance());
+	    CBCTT::in = faculty != NULL ? *faculty : Faculty(o.instance());
         
         /*************************************
          * PARAMETERS                        *
@@ -139,6 +289,12 @@ public:
             for (unsigned int i = 0; i < in.CourseVector(c).Lectures(); i++)
                 course_of_lecture[l++] = c;
 
+        // Families of constraints are posted unless omitted, and their propagators are counted
+        auto posting = [omitted](ConstraintFamily f) { return (omitted & (1u << f)) == 0; };
+        family_propagators.assign(FAMILIES, 0);
+        unsigned int mark = propagators();
+        auto posted = [&](ConstraintFamily f) { family_propagators[f] += propagators() - mark; mark = propagators(); };
+
         /************************************
         * VARIABLES                         *
         ************************************/
@@ -163,6 +319,7 @@ public:
             rel(*this, day[l] == period[l] / in.PeriodsPerDay());
             rel(*this, room[l] == roomslot[l] % in.Rooms());
         }
+        posted(FAMILY_CHANNELING);
         
         //for (unsigned int r = 0; r < total_roomslots; r++)
         //    for(unsigned int l = 0; l < total_lectures; l++)
@@ -176,17 +333,21 @@ public:
         pass; 
 
         // [RoomOccupancy] lectures must be scheduled different roomslots
+        if (posting(FAMILY_DUPLICATES))
+        {
 #ifdef HARD_DUPLICATES
-        distinct(*this, roomslot);
+            distinct(*this, roomslot);
 #else
-        // Number of duplicates
-        nvalues(*this, roomslot, IRT_EQ, duplicates);
+            // Number of duplicates
+            nvalues(*this, roomslot, IRT_EQ, duplicates);
 #endif
+        }
+        posted(FAMILY_DUPLICATES);
         
         // [Conflicts] lectures of (1) same course, (2) course in the same curriculum or (3) taught by the same professor must be scheduled different periods
 
         // 1. Lectures of same course must be scheduled different periods
-        for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int c = 0; c < in.Courses() && posting(FAMILY_ORDERING); c++)
             for (unsigned int l1 = 0; l1 < in.CourseVector(c).Lectures() - 1; l1++)
                 for (unsigned int l2 = l1 + 1; l2 < in.CourseVector(c).Lectures(); l2++)
                 {
@@ -203,6 +364,7 @@ public:
                     rel(*this, (timeslot[cl1] == timeslot[cl2]) >> (day[cl1] < day[cl2]));
                     
                 }
+        posted(FAMILY_ORDERING);
 
         // 2,3. Lectures in courses by the same teacher, or courses in the same curriculum must be scheduled different periods 
 
@@ -213,7 +375,7 @@ public:
         
         cc = 0;
 #endif
-        for (unsigned int c1 = 0; c1 < in.Courses() - 1; c1++)
+        for (unsigned int c1 = 0; c1 < in.Courses() - 1 && posting(FAMILY_CONFLICTS); c1++)
         {
             for (unsigned int c2 = c1 + 1; c2 < in.Courses(); c2++)
             {                
@@ -262,12 +424,13 @@ public:
 #else
         conflicts = expr(*this, 0);
 #endif
+        posted(FAMILY_CONFLICTS);
         
         
         // [LNS: ConflictingLectures] auxiliary variable to facilitate LNS relaxation
         conflicting_lectures = IntVarArray(*this, total_lectures, 0, total_lectures);
         
-        for (int l1 = 0; l1 < total_lectures; l1++)
+        for (int l1 = 0; l1 < total_lectures && posting(FAMILY_CONFLICTING_LECTURES); l1++)
         {
             int c1 = in.LectureCourse(l1);
             
@@ -290,10 +453,11 @@ public:
             */
             count(*this, candidate_conflicts, period[l1], IRT_EQ, conflicting_lectures[l1]);
         }
+        posted(FAMILY_CONFLICTING_LECTURES);
         
         
         // [Availabilities] Some courses may not be available in some periods, scheduling of related lectures must be handled accordingly
-        for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int c = 0; c < in.Courses() && posting(FAMILY_AVAILABILITY); c++)
             for (unsigned int p = 0; p < in.Periods(); p++)
             {
                 // Skip constraint posting if course is available
@@ -310,11 +474,12 @@ public:
                         rel(*this, roomslot[index_of_start_lecture[c] + l] != p * in.Rooms() + r);
                 }
             }
+        posted(FAMILY_AVAILABILITY);
 
 #ifdef HARD_ROOM_CAPACITY
 
         // [RoomCapacity] (Hard) lectures must be scheduled in rooms compatible with their number of students  
-        for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int c = 0; c < in.Courses() && posting(FAMILY_CAPACITY); c++)
             for (unsigned int r = 0; r < in.Rooms(); r++)
             {
                 // If number of students in course is compatible, skip constraint posting
@@ -341,8 +506,11 @@ public:
         for (unsigned int r = 0; r < in.Rooms(); r++)
             room_capacity[r] = in.RoomVector(r + 1).Capacity();
 
+        // When the family is omitted the deviations are 0, so that the cost stays bounded
         room_capacity_deviation = IntVarArray(*this, total_lectures);
-        for (unsigned int l = 0; l < total_lectures; l++)
+        for (unsigned int l = 0; l < total_lectures && !posting(FAMILY_CAPACITY); l++)
+            room_capacity_deviation[l] = IntVar(*this, 0, 0);
+        for (unsigned int l = 0; l < total_lectures && posting(FAMILY_CAPACITY); l++)
         {
             IntVar room_l_occupation = expr(*this, element(room_capacity, room[l]));
             room_capacity_deviation[l] = expr(*this, max(0, in.CourseVector(course_of_lecture[l]).Students() - room_l_occupation));
@@ -350,22 +518,24 @@ public:
 
         room_capacity_cost = expr(*this, sum(room_capacity_deviation));
 #endif
+        posted(FAMILY_CAPACITY);
 
         // [RoomStability] (Soft) all lectures of a course should be given in the same room 
 
         room_stability_deviation = IntVarArray(*this, in.Courses(), 0, total_lectures);
-        for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int c = 0; c < in.Courses() && posting(FAMILY_STABILITY); c++)
             // Count the number of different rooms used by this course
             nvalues(*this, room.slice(index_of_start_lecture[c], 1, in.CourseVector(c).Lectures()), IRT_EQ, room_stability_deviation[c]);
 
         // Take the sum of all different rooms by course, subtract one room per course
         room_stability_cost = expr(*this, sum(room_stability_deviation) - in.Courses());
+        posted(FAMILY_STABILITY);
 
         // [MinimumWorkingDays] lectures of each course must be scheduled in at least a given number of working days
         minimum_working_days_deviation = IntVarArray(*this, in.Courses(), 0, total_lectures);
         IntVarArgs days(*this, in.Courses(), 0, total_lectures);
         
-        for(unsigned int c = 0; c < in.Courses(); c++)
+        for(unsigned int c = 0; c < in.Courses() && posting(FAMILY_WORKING_DAYS); c++)
         {
             // Note to self: there is no singular IntArg, to avoid posting IntVar use plural IntVarArg (days)
             
@@ -382,13 +552,14 @@ public:
         }
 
         minimum_working_days_cost = expr(*this, sum(minimum_working_days_deviation));
+        posted(FAMILY_WORKING_DAYS);
 
         // [CurriculumCompactness] (Soft) all lectures of a curriculum should be adjacent to each other within the same day 
 
         curriculum_compactness_deviation = IntVarArray(*this, in.Curricula(), 0, total_lectures);
         lecture_compactness = BoolVarArray(*this, in.TotalLectures(), 0, 1);
 
-        for(unsigned int q = 0; q < in.Curricula(); q++)
+        for(unsigned int q = 0; q < in.Curricula() && posting(FAMILY_COMPACTNESS); q++)
         {                               
             // Gather all lectures in the same curriculum
             vector<int> lectures;
@@ -443,6 +614,7 @@ public:
 
         // Accumulate all violations
         curriculum_compactness_cost = expr(*this, sum(curriculum_compactness_deviation));
+        posted(FAMILY_COMPACTNESS);
 
         // Cost function
         z = expr(*this, 
@@ -668,29 +840,242 @@ public:
 
 class LNSCBCTT : public CBCTT, public LNSAbstractSpace
 {
+protected:
+
+    /** Relaxation operator used by relax() */
+    RelaxationType relaxation;
+
+    /** Options the model has been created with (they outlive the search) */
+    const CBCTTOptions* options;
+
+    /** Branching heuristics for neighborhoods */
+    NeighborhoodVariableType neighborhood_variables;
+    NeighborhoodValueType neighborhood_values;
+
+    /** Activity of the roomslots, shared by all the neighbors (i.e., clones of the root space) */
+    IntActivity activity;
+
+    /** Roomslots of the old timetable, when re-solving with minimal perturbation (-1 for the lectures without one) */
+    SharedArray<int> reference;
+
+    /** Number of re-scheduled lectures moved from their roomslot in the old timetable */
+    IntVar perturbation;
+
+    /** Lectures which can be relaxed (the re-scheduled ones when re-solving, all of them otherwise) */
+    SharedArray<int> relaxable;
+
+    /** Fix the lectures which are not affected by the instance edit, and add the perturbation to the cost */
+    void post_perturbation(const CBCTTOptions& o);
+
+    /** Roomslots of the solution a neighbor has been relaxed from (phase saving) */
+    SharedArray<int> guide;
+
+    /** Whether the branching of each neighborhood is chosen by the meta-engine among neighborhood_strategies() */
+    bool strategies() const
+    {
+        return options->bandit() != LNS_BANDIT_NONE;
+    }
+
+    /** Record the roomslots of this solution in the tentative neighbor, for guided value selection */
+    void save_phases(LNSCBCTT* tentative) const
+    {
+        if (neighborhood_values != NB_VAL_GUIDED && !strategies())
+            return;
+        LNS_PROFILE_SCOPE(Search::Meta::LNS_PHASE_PHASE_SAVING);
+        tentative->guide = SharedArray<int>(roomslot.size());
+        for (int i = 0; i < roomslot.size(); i++)
+            tentative->guide[i] = roomslot[i].val();
+    }
+
 public:
 
 
-    LNSCBCTT(const InstanceOptions& o) : CBCTT(o) { }
+    LNSCBCTT(const CBCTTOptions& o, const Faculty* faculty = NULL) : CBCTT(o, 0, faculty), relaxation(o.relaxation()), options(&o), 
+        neighborhood_variables(o.neighborhoodVariables()), neighborhood_values(o.neighborhoodValues())
+    {
+        if (neighborhood_variables == NB_VAR_ACTIVITY || strategies())
+            activity = IntActivity(*this, roomslot, 0.99);
+        if (o.oldInstance() != NULL && o.oldSolution() != NULL)
+            post_perturbation(o);
+        else
+        {
+            perturbation = IntVar(*this, 0, 0);
+            relaxable = SharedArray<int>(roomslot.size());
+            for (int l = 0; l < roomslot.size(); l++)
+                relaxable[l] = l;
+        }
+    }
 
-    LNSCBCTT(bool share, LNSCBCTT& t) : CBCTT(share, t) { }
+    LNSCBCTT(bool share, LNSCBCTT& t) : CBCTT(share, t), relaxation(t.relaxation), options(t.options),
+        neighborhood_variables(t.neighborhood_variables), neighborhood_values(t.neighborhood_values)
+    {
+        if (neighborhood_variables == NB_VAR_ACTIVITY || strategies())
+            activity.update(*this, share, t.activity);
+        guide.update(*this, share, t.guide);
+        reference.update(*this, share, t.reference);
+        perturbation.update(*this, share, t.perturbation);
+        relaxable.update(*this, share, t.relaxable);
+    }
+    
+    virtual void print(ostream& os = cout) const
+    {
+        CBCTT::print(os);
+        if (reference.size() > 0)
+            os << "Perturbation\t" << perturbation << " (x" << options->perturbationWeight() << ")" << endl;
+    }
+    
+    /** Parameters for the LNS meta-engine searching this model */
+    const LNSBaseOptions& lns_options() const
+    {
+        return *options;
+    }
     
     virtual unsigned int relaxable_vars() const
     {
-        return roomslot.size();
+        return relaxable.size();
     }
   
     virtual void initial_solution_branching(unsigned long int restarts);
     
+    /** Kempe chain and period swap local search from this solution, with room re-optimization per period (see local_search.hh) */
+    virtual unsigned int local_search(Gecode::Space* tentative);
+    
+    /** Conflicts, overlapping lectures and the four (unweighted) soft cost components */
+    virtual unsigned int cost_components() const
+    {
+        return 6;
+    }
+    
+    virtual const char* cost_component_name(unsigned int i) const
+    {
+        static const char* names[] = { "conflicts", "overlaps", "room_capacity", "room_stability", "min_working_days", "curriculum_compactness" };
+        return names[i];
+    }
+    
+    virtual double cost_component(unsigned int i) const
+    {
+        switch (i)
+        {
+            case 0: return conflicts.val();
+            case 1: return in.TotalLectures() - duplicates.val();
+            case 2: return room_capacity_cost.val();
+            case 3: return room_stability_cost.val();
+            case 4: return minimum_working_days_cost.val();
+            default: return curriculum_compactness_cost.val();
+        }
+    }
+    
+    /** Roomslots of the lectures, for checkpointing */
+    virtual void save(vector<int>& v) const
+    {
+        for (int l = 0; l < roomslot.size(); l++)
+            v.push_back(roomslot[l].val());
+    }
+    
+    /** Fix the roomslots of the lectures to the saved ones */
+    virtual bool restore(const vector<int>& v)
+    {
+        if (v.size() != (unsigned int) roomslot.size())
+            return false;
+        for (int l = 0; l < roomslot.size(); l++)
+            rel(*this, roomslot[l] == v[l]);
+        return status() != SS_FAILED;
+    }
+    
+    /** Whether the solution has no conflicts and no overlapping lectures */
+    virtual bool feasible() const
+    {
+        return conflicts.val() == 0 && duplicates.val() == (int) in.TotalLectures();
+    }
+    
     virtual void neighborhood_branching();
+    
+    /** 
+    Alternative branchings for neighborhoods, to be chosen by a bandit: the
+    configured one, then degree/min, afc/guided, activity/guided and random.
+     */
+    virtual unsigned int neighborhood_strategies() const
+    {
+        return 5;
+    }
+    
+    virtual void neighborhood_strategy(unsigned int s);
+    
+    virtual const char* neighborhood_strategy_name(unsigned int s) const;
+    
+    /** 
+    Value selection for guided neighborhoods: the roomslot of the lecture in the
+    solution the neighbor has been relaxed from if still available, otherwise the 
+    closest one (same period first, then same room in the closest periods).
+     */
+    static int guided_value(const Gecode::Space& home, Gecode::IntVar x, int i);
   
+    /** Relax variables with the configured relaxation operator. */
+    unsigned int relax(Gecode::Space* tentative_s, unsigned int free)
+    {
+        save_phases(static_cast<LNSCBCTT*>(tentative_s));
+        // Propagation guidance is only meaningful once hard constraints can be posted
+        if (violations() == 0)
+        {
+            if (relaxation == RELAX_PROPAGATION_GUIDED || (relaxation == RELAX_MIXED && Random::Int(0, 1)))
+                return relax_propagation_guided(tentative_s, free);
+        }
+        return relax_heuristic(tentative_s, free);
+    }
+    
+    /** Number of lectures in a different roomslot than in s */
+    virtual unsigned int distance(const Gecode::Space& s) const
+    {
+        const LNSCBCTT& t = static_cast<const LNSCBCTT&>(s);
+        unsigned int d = 0;
+        for (int i = 0; i < roomslot.size(); i++)
+            if (roomslot[i].val() != t.roomslot[i].val())
+                d++;
+        return d;
+    }
+    
+    /**
+    Relax the lectures that are in a different roomslot than in guide,
+    plus <free> random lectures among the ones on which the two solutions 
+    agree. The remaining lectures are fixed to their (common) roomslot.
+     */
+    virtual unsigned int relink(Gecode::Space* tentative_s, const Gecode::Space& guide_s, unsigned int free)
+    {
+        LNSCBCTT* tentative = static_cast<LNSCBCTT*>(tentative_s);
+        const LNSCBCTT& guide = static_cast<const LNSCBCTT&>(guide_s);
+        save_phases(tentative);
+        
+        vector<int> agree;
+        for (int i = 0; i < relaxable.size(); i++)
+            if (roomslot[relaxable[i]].val() == guide.roomslot[relaxable[i]].val())
+                agree.push_back(relaxable[i]);
+        
+        Random::Shuffle(agree.begin(), agree.end());
+        for (unsigned int f = free; f > 0 && !agree.empty(); f--)
+            agree.pop_back();
+        
+        for (int s : agree)
+            rel(*tentative, tentative->roomslot[s] == roomslot[s].val());
+        
+        return (int)relaxable.size() - (int)agree.size();
+    }
+    
+    /**
+    Relax variables by propagation-guided LNS: starting from a random seed 
+    lecture, the lectures to free are fixed one by one on a scratch copy of
+    the neighbor, and the next lecture to free is the one whose domains were
+    most reduced by propagation so far, i.e., the most tightly coupled one.
+    The lectures that are not freed are fixed in the neighbor.
+     */
+    unsigned int relax_propagation_guided(Gecode::Space* tentative_s, unsigned int free);
+    
     /**
     Relax variables according to heuristics based on the the constraints
     that are yet to satisfy or the cost components that are yet to minimize. 
     For each heuristic, the number of actually freed variables is recorded 
     (freed), in the end, (free+freed random variables are freed).
      */
-    unsigned int relax(Gecode::Space* tentative_s, unsigned int free)
+    unsigned int relax_heuristic(Gecode::Space* tentative_s, unsigned int free)
     {
       
         CBCTT* tentative = static_cast<CBCTT*>(tentative_s);
@@ -703,21 +1088,21 @@ public:
         /* --- NOT IN GECODE-LNS
          
 //#ifdef TOTALLY_RANDOM
-        double rn = (double)rand() / (double)RAND_MAX;
+        double rn = Random::Double();
         MyLNS::random = rn < MyLNS::random_relaxation;
 //#endif
          
        */
 
-        // Partition slots in conflicting, non conflicting and all
+        // Partition relaxable slots in conflicting, non conflicting and all
         vector<int> all;
         vector<int> conflicting;
         
-        for (int i = 0; i < roomslot.size(); i++)
+        for (int i = 0; i < relaxable.size(); i++)
         {
-            all.push_back(i);
-            if (conflicting_lectures[i].val() > 0)
-                conflicting.push_back(i);
+            all.push_back(relaxable[i]);
+            if (conflicting_lectures[relaxable[i]].val() > 0)
+                conflicting.push_back(relaxable[i]);
         }
 
 
@@ -726,7 +1111,7 @@ public:
             if (conflicts.val())
             {
                 // Pick random conflicting lecture
-                random_shuffle(conflicting.begin(), conflicting.end());
+                Random::Shuffle(conflicting.begin(), conflicting.end());
                 
                 // Budget of conflicts (1)
                 int conf = 1;
@@ -797,7 +1182,7 @@ public:
                         to_fix.push_back(l);
                 }
                 
-                random_shuffle(to_fix.begin(), to_fix.end());
+                Random::Shuffle(to_fix.begin(), to_fix.end());
                 
                 // Release a number of variables to fix
                 unsigned int dupfix = free;
@@ -829,7 +1214,7 @@ public:
                 for (int i = 0; i < roomslot.size(); i++)
                     all.push_back(i);
                 
-                random_shuffle(all.begin(), all.end());
+                Random::Shuffle(all.begin(), all.end());
                 
                 for (int i = 0; i < free; i++)
                     all.pop_back();
@@ -875,7 +1260,7 @@ public:
                     if (room_stability_deviation[c].val() > 0)
                         unstable_courses.push_back(c);
                 
-                random_shuffle(unstable_courses.begin(), unstable_courses.end());
+                Random::Shuffle(unstable_courses.begin(), unstable_courses.end());
                 
                 for (unsigned int ci  = 0; ci < unstable_courses.size() && room_stability >= 1; ci++)
                 {
@@ -905,7 +1290,7 @@ public:
                         for (int l = 0; l < in.CourseVector(c).Lectures(); l++)
                             lectures.push_back(index_of_start_lecture[c]+l);
                         
-                        random_shuffle(lectures.begin(), lectures.end());
+                        Random::Shuffle(lectures.begin(), lectures.end());
                         
                         for (int l : lectures)
                         {
@@ -932,7 +1317,7 @@ public:
                     if (find(all.begin(), all.end(), l) != all.end() && lecture_compactness[l].val())
                         lectures.push_back(l);
                 
-                random_shuffle(lectures.begin(), lectures.end());
+                Random::Shuffle(lectures.begin(), lectures.end());
                 
                 while (curriculum_compactness >= 1 && lectures.size())
                 {
@@ -949,7 +1334,7 @@ public:
                 bool chosen = false;
                 
                 // Choose random component to optimize (stochastically at random based on cost)
-                double r = ((double)rand() / (double)RAND_MAX) * cost().val();
+                double r = Random::Double() * cost().val();
                 double inc = 0;
                 
                 // Fall in room capacity?
@@ -984,7 +1369,7 @@ public:
                         if (room_stability_deviation[c].val() > 0)
                             unstable_courses.push_back(c);
                     
-                    random_shuffle(unstable_courses.begin(), unstable_courses.end());
+                    Random::Shuffle(unstable_courses.begin(), unstable_courses.end());
                     
                     for (unsigned int ci  = 0; ci < unstable_courses.size() && room_stability >= 1; ci++)
                     {
@@ -1018,7 +1403,7 @@ public:
                         if (find(all.begin(), all.end(), l) != all.end() && lecture_compactness[l].val())
                             lectures.push_back(l);
                     
-                    random_shuffle(lectures.begin(), lectures.end());
+                    Random::Shuffle(lectures.begin(), lectures.end());
                     
                     while (curriculum_compactness >= 1 && lectures.size())
                     {
@@ -1048,7 +1433,7 @@ public:
                             for (int l = 0; l < in.CourseVector(c).Lectures(); l++)
                                 lectures.push_back(index_of_start_lecture[c]+l);
                             
-                            random_shuffle(lectures.begin(), lectures.end());
+                            Random::Shuffle(lectures.begin(), lectures.end());
                             
                             for (int l : lectures)
                             {
@@ -1069,7 +1454,7 @@ public:
             }
         }
         
-        random_shuffle(all.begin(), all.end());
+        Random::Shuffle(all.begin(), all.end());
 
         int f = freed + free;
         // Release a total of <free> variables, plus a number of variables equals to the ones freed heuristically (<freed>)
@@ -1091,7 +1476,7 @@ public:
         c++;
         */
         
-        return (int)roomslot.size() - (int)all.size();
+        return (int)relaxable.size() - (int)all.size();
         
     }
     
@@ -1125,7 +1510,10 @@ public:
         else
         {
             post_hard_constraints();            
-            rel(*this, z < cb.cost().val() + delta);
+            if (strict)
+                rel(*this, z < cb.cost().val() + delta);
+            else
+                rel(*this, z <= cb.cost().val() + delta);
         }
     }
   
@@ -1144,11 +1532,17 @@ public:
       
       if (cb.cost().val() > cost().val())
         return true;
-      if (!strict && cb.cost().val() > cost().val())
+      if (!strict && cb.cost().val() >= cost().val())
         return true;
       return false;
       
     }
+    
+    /** Cost of the solution (only meaningful once the hard constraints are satisfied) */
+    virtual double objective() const
+    {
+        return cost().val();
+    }
   
     /** Post all hard constraints */
     virtual void post_hard_constraints()
@@ -0,0 +1,357 @@
+#include "../CBCTT.hh"
+#include "bench.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <sys/stat.h>
+
+using namespace std;
+
+/**
+ Anytime behaviour of the solver, i.e., the cost reached after a given time rather
+ than the final one.
+
+ Each run (an instance, a parameter set and a seed) is carried out by its own process,
+ and as many runs as requested are carried out in parallel. A run records every
+ improving solution returned by the LNS with its time (since the start of the run),
+ and cross-checks the cost of each feasible solution against its recomputation from
+ the timetable (see KempeSearch::cost); a run with a mismatch is reported, and makes
+ the harness fail.
+
+ The traces of the runs are then aggregated into anytime profiles (median and
+ interquartile range of the best feasible cost at given times) and time-to-target
+ distributions, whose targets are the best cost found on each instance by any run,
+ increased by given gaps.
+ */
+class AnytimeOptions : public CBCTTOptions
+{
+public:
+
+    AnytimeOptions(const char* p) : CBCTTOptions(p),
+    _instances("-anytime_instances", "directory of instances (.ctt/.ectt) to be run (default: the -instance one)"),
+    _seeds("-anytime_seeds", "number of seeds run on each instance with each parameter set, from -seed on", 10),
+    _budget("-anytime_budget", "time budget of each run (s)", 600),
+    _parameters("-anytime_parameters", "file with a parameter set (a name followed by solver options) per line (default: the options given)"),
+    _jobs("-anytime_jobs", "number of runs carried out in parallel (0: one per core)", 0),
+    _times("-anytime_times", "comma separated times (s) of the anytime profile", "10,60,600"),
+    _gaps("-anytime_gaps", "comma separated gaps from the best cost of the time-to-target targets", "0,0.01,0.05"),
+    _output("-anytime_output", "directory the traces and the tables are written to", "anytime")
+    {
+        add(_instances);
+        add(_seeds);
+        add(_budget);
+        add(_parameters);
+        add(_jobs);
+        add(_times);
+        add(_gaps);
+        add(_output);
+    }
+
+    const char* instances(void) const { return _instances.value(); }
+    unsigned int seeds(void) const { return _seeds.value(); }
+    double budget(void) const { return _budget.value(); }
+    const char* parameters(void) const { return _parameters.value(); }
+    unsigned int jobs(void) const { return _jobs.value(); }
+    const char* times(void) const { return _times.value(); }
+    const char* gaps(void) const { return _gaps.value(); }
+    const char* output(void) const { return _output.value(); }
+
+protected:
+
+    Driver::StringValueOption _instances;
+    Driver::UnsignedIntOption _seeds;
+    Driver::DoubleOption _budget;
+    Driver::StringValueOption _parameters;
+    Driver::UnsignedIntOption _jobs;
+    Driver::StringValueOption _times;
+    Driver::StringValueOption _gaps;
+    Driver::StringValueOption _output;
+};
+
+/** A run of the solver */
+struct Run
+{
+    string instance;
+    unsigned int parameters;
+    unsigned int seed;
+    /** File the improving solutions are written to */
+    string trace;
+};
+
+/** A feasible improving solution of a run */
+struct Improvement
+{
+    double time;
+    int cost;
+};
+
+/** A set of solver options */
+typedef pair<string, vector<string> > ParameterSet;
+
+/** Comma separated numbers */
+static vector<double> numbers(const string& list)
+{
+    vector<double> v;
+    istringstream is(list);
+    string n;
+    while (getline(is, n, ','))
+        v.push_back(stod(n));
+    return v;
+}
+
+/** Parameter sets of a file (or the options given, if none) */
+static vector<ParameterSet> parameter_sets(const char* file)
+{
+    vector<ParameterSet> sets;
+    if (file == NULL)
+    {
+        sets.push_back(ParameterSet("default", vector<string>()));
+        return sets;
+    }
+    ifstream is(file);
+    if (!is)
+        throw runtime_error(string("Cannot open parameters file ") + file);
+    string line;
+    while (getline(is, line))
+    {
+        istringstream ls(line);
+        string name, option;
+        if (!(ls >> name) || name[0] == '#')
+            continue;
+        ParameterSet set(name, vector<string>());
+        while (ls >> option)
+            set.second.push_back(option);
+        sets.push_back(set);
+    }
+    return sets;
+}
+
+/** Carry out a run (in a child process) with the given command line, returns its exit status (2 if a cost does not match its recomputation) */
+static int solve(const Run& run, vector<string> args)
+{
+    args.push_back("-instance");
+    args.push_back(run.instance);
+    args.push_back("-seed");
+    args.push_back(to_string(run.seed));
+    AnytimeOptions opt("");
+    parse(opt, args);
+    Random::Seed(opt.seed());
+
+    ofstream trace(run.trace.c_str());
+    trace << "time_s,cost,violations,recomputed" << endl;
+    auto start = chrono::steady_clock::now();
+    LNSCBCTT* s = new LNSCBCTT(opt);
+    KempeSearch check(CBCTT::in);
+    const unsigned int rooms = CBCTT::in.Rooms();
+    Search::Options so;
+    so.stop = new Search::TimeStop(static_cast<unsigned long int>(opt.budget() * 1000));
+    unsigned int mismatches = 0;
+    {
+        LNS<BAB, LNSCBCTT> e(s, so, s->lns_options());
+        while (LNSCBCTT* solution = e.next())
+        {
+            double time = elapsed(start) / 1000;
+            int cost = solution->cost().val(), recomputed = -1;
+            unsigned int violations = solution->violations();
+            // The standalone cost knows nothing of the perturbation of an old timetable
+            if (violations == 0 && opt.oldSolution() == NULL)
+            {
+                vector<unsigned int> period(solution->roomslot.size()), room(solution->roomslot.size());
+                for (int l = 0; l < solution->roomslot.size(); l++)
+                {
+                    period[l] = solution->roomslot[l].val() / rooms;
+                    room[l] = solution->roomslot[l].val() % rooms;
+                }
+                recomputed = check.cost(period, room);
+                if (recomputed != cost)
+                    mismatches++;
+            }
+            trace << time << "," << cost << "," << violations << "," << recomputed << endl;
+            delete solution;
+        }
+    }
+    delete s;
+    delete so.stop;
+    return mismatches > 0 ? 2 : 0;
+}
+
+/** Feasible improving solutions in the trace of a run */
+static vector<Improvement> read_trace(const string& file)
+{
+    vector<Improvement> improvements;
+    ifstream is(file.c_str());
+    string line;
+    getline(is, line); // header
+    while (getline(is, line))
+    {
+        vector<double> v = numbers(line);
+        if (v.size() == 4 && v[2] == 0)
+            improvements.push_back(Improvement{v[0], (int) v[1]});
+    }
+    return improvements;
+}
+
+/** Median and interquartile range of sorted values (infinite values are printed as "-") */
+static string summary(const vector<double>& sorted)
+{
+    ostringstream os;
+    double q[3] = { quantile(sorted, 0.25), quantile(sorted, 0.5), quantile(sorted, 0.75) };
+    string s[3];
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        ostringstream qs;
+        if (q[i] == numeric_limits<double>::infinity())
+            qs << "-";
+        else
+            qs << q[i];
+        s[i] = qs.str();
+    }
+    os << s[1] << " [" << s[0] << ", " << s[2] << "]";
+    return os.str();
+}
+
+int main(int argc, char * argv[])
+{
+    // The runs are given the same command line, followed by the options of their parameter set
+    vector<string> args(argv, argv + argc);
+    AnytimeOptions opt("");
+    parse(opt, args);
+
+    try
+    {
+        vector<string> instances;
+        if (opt.instances() != NULL)
+            instances = instance_files(opt.instances());
+        else
+            instances.push_back(opt.instance());
+        vector<ParameterSet> sets = parameter_sets(opt.parameters());
+        vector<double> times = numbers(opt.times()), gaps = numbers(opt.gaps());
+        const string output = opt.output();
+        if (mkdir(output.c_str(), 0755) != 0 && errno != EEXIST)
+            throw runtime_error("Cannot create directory " + output);
+
+        vector<Run> runs;
+        for (unsigned int i = 0; i < instances.size(); i++)
+            for (unsigned int p = 0; p < sets.size(); p++)
+                for (unsigned int k = 0; k < opt.seeds(); k++)
+                {
+                    Run run = { instances[i], p, opt.seed() + k, "" };
+                    run.trace = output + "/" + instance_name(run.instance) + "." + sets[p].first + "." + to_string(run.seed) + ".csv";
+                    runs.push_back(run);
+                }
+
+        // Carry out the runs, each one in its own process
+        unsigned int done = 0, failed = 0, mismatched = 0;
+        run_processes(runs.size(), opt.jobs(),
+            [&](unsigned int r)
+            {
+                vector<string> a = args;
+                a.insert(a.end(), sets[runs[r].parameters].second.begin(), sets[runs[r].parameters].second.end());
+                return solve(runs[r], a);
+            },
+            [&](unsigned int r, int status)
+            {
+                if (status == 2)
+                {
+                    mismatched++;
+                    cerr << "Anytime: the cost of a solution does not match its recomputation in " << runs[r].trace << endl;
+                }
+                else if (status != 0)
+                {
+                    failed++;
+                    cerr << "Anytime: run " << runs[r].trace << " failed" << endl;
+                }
+                cerr << "Anytime: " << ++done << "/" << runs.size() << " runs done" << endl;
+            });
+
+        // Best feasible cost of each run at each time, and targets of each instance
+        vector<vector<Improvement> > traces(runs.size());
+        map<string, int> best;
+        for (unsigned int r = 0; r < runs.size(); r++)
+        {
+            traces[r] = read_trace(runs[r].trace);
+            for (unsigned int i = 0; i < traces[r].size(); i++)
+                if (best.count(runs[r].instance) == 0 || traces[r][i].cost < best[runs[r].instance])
+                    best[runs[r].instance] = traces[r][i].cost;
+        }
+
+        ofstream profile((output + "/anytime.csv").c_str()), ttt((output + "/ttt.csv").c_str());
+        profile << "instance,parameters,time_s,runs,feasible,q1,median,q3" << endl;
+        ttt << "instance,parameters,gap,target,seed,time_s" << endl;
+
+        cout << "Anytime profile: best feasible cost at each time, median [Q1, Q3] (runs with a feasible solution)" << endl;
+        cout << left << setw(20) << "instance" << setw(16) << "parameters";
+        for (unsigned int t = 0; t < times.size(); t++)
+            cout << setw(28) << (to_string((int) times[t]) + "s");
+        cout << endl;
+        for (unsigned int r = 0; r < runs.size(); r += opt.seeds())
+        {
+            cout << setw(20) << instance_name(runs[r].instance) << setw(16) << sets[runs[r].parameters].first;
+            for (unsigned int t = 0; t < times.size(); t++)
+            {
+                vector<double> costs;
+                for (unsigned int k = r; k < r + opt.seeds(); k++)
+                {
+                    double cost = numeric_limits<double>::infinity();
+                    for (unsigned int i = 0; i < traces[k].size() && traces[k][i].time <= times[t]; i++)
+                        cost = min(cost, (double) traces[k][i].cost);
+                    costs.push_back(cost);
+                }
+                sort(costs.begin(), costs.end());
+                unsigned int feasible = count_if(costs.begin(), costs.end(), [](double c) { return c != numeric_limits<double>::infinity(); });
+                cout << setw(28) << (summary(costs) + " (" + to_string(feasible) + "/" + to_string(costs.size()) + ")");
+                profile << quote(instance_name(runs[r].instance)) << "," << quote(sets[runs[r].parameters].first) << "," << times[t] << ","
+                        << costs.size() << "," << feasible << "," << quantile(costs, 0.25) << "," << quantile(costs, 0.5) << "," << quantile(costs, 0.75) << endl;
+            }
+            cout << endl;
+        }
+
+        cout << endl << "Time to target (s): median [Q1, Q3] (runs reaching the target), targets are the best cost increased by the gap" << endl;
+        cout << left << setw(20) << "instance" << setw(16) << "parameters";
+        for (unsigned int g = 0; g < gaps.size(); g++)
+            cout << setw(28) << ("gap " + to_string(gaps[g]).substr(0, 4));
+        cout << endl;
+        for (unsigned int r = 0; r < runs.size(); r += opt.seeds())
+        {
+            cout << setw(20) << instance_name(runs[r].instance) << setw(16) << sets[runs[r].parameters].first;
+            for (unsigned int g = 0; g < gaps.size(); g++)
+            {
+                int target = best.count(runs[r].instance) ? (int) floor(best[runs[r].instance] * (1 + gaps[g])) : -1;
+                vector<double> ttts;
+                for (unsigned int k = r; k < r + opt.seeds(); k++)
+                {
+                    double time = numeric_limits<double>::infinity();
+                    for (unsigned int i = 0; i < traces[k].size() && time == numeric_limits<double>::infinity(); i++)
+                        if (traces[k][i].cost <= target)
+                            time = traces[k][i].time;
+                    ttts.push_back(time);
+                    ttt << quote(instance_name(runs[r].instance)) << "," << quote(sets[runs[r].parameters].first) << "," << gaps[g] << ","
+                        << target << "," << runs[k].seed << ",";
+                    if (time != numeric_limits<double>::infinity())
+                        ttt << time;
+                    ttt << endl;
+                }
+                sort(ttts.begin(), ttts.end());
+                unsigned int reached = count_if(ttts.begin(), ttts.end(), [](double t) { return t != numeric_limits<double>::infinity(); });
+                cout << setw(28) << (summary(ttts) + " (" + to_string(reached) + "/" + to_string(ttts.size()) + ")");
+            }
+            cout << endl;
+        }
+
+        if (failed > 0 || mismatched > 0)
+        {
+            cerr << "Anytime: " << failed << " failed runs, " << mismatched << " runs with mismatching costs" << endl;
+            return 1;
+        }
+    }
+    catch (std::exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
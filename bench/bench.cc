@@ -0,0 +1,105 @@
+#include "bench.hh"
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+double elapsed(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+string quote(const string& s)
+{
+    string q = "\"";
+    for (unsigned int i = 0; i < s.size(); i++)
+    {
+        if (s[i] == '"' || s[i] == '\\')
+            q += '\\';
+        q += s[i];
+    }
+    return q + "\"";
+}
+
+vector<string> instance_files(const string& dir)
+{
+    vector<string> files;
+    DIR* d = opendir(dir.c_str());
+    if (d == NULL)
+        throw runtime_error("Cannot open directory " + dir);
+    for (struct dirent* e = readdir(d); e != NULL; e = readdir(d))
+    {
+        string name = e->d_name;
+        if ((name.size() > 4 && name.substr(name.size() - 4) == ".ctt") || (name.size() > 5 && name.substr(name.size() - 5) == ".ectt"))
+            files.push_back(dir + "/" + name);
+    }
+    closedir(d);
+    sort(files.begin(), files.end());
+    return files;
+}
+
+string instance_name(const string& file)
+{
+    string name = file.substr(file.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+double quantile(const vector<double>& sorted, double q)
+{
+    if (sorted.empty())
+        return 0;
+    double position = q * (sorted.size() - 1);
+    unsigned int i = (unsigned int) position;
+    if (i + 1 >= sorted.size() || sorted[i] == sorted[i + 1])
+        return sorted[i];
+    // Infinite values (e.g., runs which never reached a target) are not interpolated
+    if (isinf(sorted[i + 1]))
+        return position > i ? sorted[i + 1] : sorted[i];
+    return sorted[i] + (position - i) * (sorted[i + 1] - sorted[i]);
+}
+
+void run_processes(unsigned int n, unsigned int jobs, const function<int(unsigned int)>& task, const function<void(unsigned int, int)>& done)
+{
+    if (jobs == 0)
+        jobs = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    map<pid_t, unsigned int> running;
+    unsigned int next = 0;
+    while (next < n || !running.empty())
+    {
+        while (running.size() < jobs && next < n)
+        {
+            cout.flush();
+            cerr.flush();
+            pid_t pid = fork();
+            if (pid < 0)
+                throw runtime_error("Cannot fork a process");
+            if (pid == 0)
+            {
+                int status = 1;
+                try
+                {
+                    status = task(next);
+                }
+                catch (std::exception& e)
+                {
+                    cerr << e.what() << endl;
+                }
+                cout.flush();
+                cerr.flush();
+                _exit(status);
+            }
+            running[pid] = next++;
+        }
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0)
+            throw runtime_error("Cannot wait for a process");
+        unsigned int i = running[pid];
+        running.erase(pid);
+        done(i, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    }
+}
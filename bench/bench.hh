@@ -0,0 +1,47 @@
+#ifndef CP_CTT_bench_hh
+#define CP_CTT_bench_hh
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+using namespace std;
+
+/** Milliseconds elapsed since start */
+double elapsed(chrono::steady_clock::time_point start);
+
+/** JSON string literal */
+string quote(const string& s);
+
+/** Instance files (.ctt or .ectt) in a directory, sorted by name */
+vector<string> instance_files(const string& dir);
+
+/** Name of an instance file, without directory and extension */
+string instance_name(const string& file);
+
+/** Quantile q (between 0 and 1) of sorted values, interpolated linearly */
+double quantile(const vector<double>& sorted, double q);
+
+/** Carry out tasks 0, ..., n - 1, each one in its own process, at most jobs (0: one per core) at a time
+ *  @param task the task, run in the child process, returns its exit status
+ *  @param done called in the parent with the index and the exit status (-1 if killed) of each task, as they complete
+ */
+void run_processes(unsigned int n, unsigned int jobs, const function<int(unsigned int)>& task, const function<void(unsigned int, int)>& done);
+
+/** Parse a command line (e.g., the one of a harness, followed by the options of a run) into the options of the solver */
+template <class Options>
+void parse(Options& opt, const vector<string>& args)
+{
+    vector<char*> argv;
+    for (unsigned int i = 0; i < args.size(); i++)
+        argv.push_back(const_cast<char*>(args[i].c_str()));
+    argv.push_back(NULL);
+    int argc = args.size();
+    opt.model(0, "debug", "debug model (print lots of stuff)");
+    opt.model(1, "experiments", "silent model only prints a solution in the end");
+    opt.model(1);
+    opt.parse(argc, argv.data());
+}
+
+#endif
@@ -0,0 +1,264 @@
+#include "../CBCTT.hh"
+#include "bench.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ Benchmarks of the solver, written as JSON so that runs on the same machine can be
+ compared across commits.
+
+ The micro benchmarks time, on each instance, the reading of the instance
+ (Faculty::Read), the construction of the model, the propagation of the root space,
+ the cloning of the root space, the relaxation of a solution (LNSCBCTT::relax) and the
+ posting of the bound on the cost (LNSCBCTT::constrain), plus the propagation of the
+ resulting neighbor. The macro benchmark runs the LNS with a fixed time budget on each
+ instance with several seeds, and records the best cost and the throughput.
+ */
+class BenchmarkOptions : public CBCTTOptions
+{
+public:
+
+    BenchmarkOptions(const char* p) : CBCTTOptions(p),
+    _instances("-bench_instances", "directory of instances (.ctt/.ectt) to be benchmarked (default: the -instance one)"),
+    _seeds("-bench_seeds", "number of seeds of the macro benchmark (0: no macro benchmark)", 3),
+    _budget("-bench_budget", "time budget of each run of the macro benchmark (s)", 10),
+    _repetitions("-bench_repetitions", "repetitions of each micro benchmark (0: no micro benchmarks)", 20),
+    _json("-bench_json", "file the results are written to (default: standard output)"),
+    _label("-bench_label", "label of the results (e.g., the commit)")
+    {
+        add(_instances);
+        add(_seeds);
+        add(_budget);
+        add(_repetitions);
+        add(_json);
+        add(_label);
+    }
+
+    const char* instances(void) const { return _instances.value(); }
+    unsigned int seeds(void) const { return _seeds.value(); }
+    double budget(void) const { return _budget.value(); }
+    unsigned int repetitions(void) const { return _repetitions.value(); }
+    const char* json(void) const { return _json.value(); }
+    const char* label(void) const { return _label.value(); }
+
+protected:
+
+    Driver::StringValueOption _instances;
+    Driver::UnsignedIntOption _seeds;
+    Driver::DoubleOption _budget;
+    Driver::UnsignedIntOption _repetitions;
+    Driver::StringValueOption _json;
+    Driver::StringValueOption _label;
+};
+
+/** Samples (ms) of a micro benchmark */
+class Samples
+{
+public:
+
+    void add(double t)
+    {
+        samples.push_back(t);
+    }
+
+    /** JSON record of the benchmark */
+    string json(const string& name, const string& instance)
+    {
+        sort(samples.begin(), samples.end());
+        double mean = 0;
+        for (unsigned int i = 0; i < samples.size(); i++)
+            mean += samples[i] / samples.size();
+        ostringstream os;
+        os << "{\"benchmark\": " << quote(name) << ", \"instance\": " << quote(instance)
+           << ", \"repetitions\": " << samples.size() << ", \"min_ms\": " << (samples.empty() ? 0 : samples.front())
+           << ", \"median_ms\": " << (samples.empty() ? 0 : samples[samples.size() / 2]) << ", \"mean_ms\": " << mean
+           << ", \"max_ms\": " << (samples.empty() ? 0 : samples.back()) << "}";
+        return os.str();
+    }
+
+protected:
+
+    vector<double> samples;
+};
+
+/** Micro benchmarks on the instance of the options, returns their JSON records */
+static vector<string> micro_benchmarks(BenchmarkOptions& opt)
+{
+    const string instance = opt.instance();
+    const unsigned int repetitions = opt.repetitions();
+    Samples parse, build, status, clone, relax, constrain, neighbor;
+
+    for (unsigned int k = 0; k < repetitions; k++)
+    {
+        Faculty in;
+        auto start = chrono::steady_clock::now();
+        in.Read(instance);
+        parse.add(elapsed(start));
+    }
+
+    // A solution to be relaxed, i.e., the first one of the LNS
+    LNSCBCTT* root = new LNSCBCTT(opt);
+    root->status();
+    Search::Options so;
+    so.stop = new Search::TimeStop(static_cast<unsigned long int>(opt.budget() * 1000));
+    LNSCBCTT* solution;
+    {
+        // The engine is destroyed before its stop: with several workers, this stops and joins
+        // the ones still running after the first solution
+        LNS<BAB, LNSCBCTT> e(root, so, root->lns_options());
+        solution = e.next();
+    }
+    delete so.stop;
+
+    unsigned int vars = root->relaxable_vars();
+    unsigned int free = opt.minIntensityRatio() > 0.0 ? (unsigned int) ceil(opt.minIntensityRatio() * vars) : opt.minIntensity();
+    free = max(1u, min(free, vars));
+
+    for (unsigned int k = 0; k < repetitions; k++)
+    {
+        auto start = chrono::steady_clock::now();
+        LNSCBCTT* s = new LNSCBCTT(opt);
+        build.add(elapsed(start));
+        start = chrono::steady_clock::now();
+        s->status();
+        status.add(elapsed(start));
+        delete s;
+
+        start = chrono::steady_clock::now();
+        LNSCBCTT* tentative = static_cast<LNSCBCTT*>(root->clone());
+        clone.add(elapsed(start));
+        if (solution == NULL)
+        {
+            delete tentative;
+            continue;
+        }
+        start = chrono::steady_clock::now();
+        solution->relax(tentative, free);
+        relax.add(elapsed(start));
+        start = chrono::steady_clock::now();
+        tentative->constrain(*solution, true, 0);
+        constrain.add(elapsed(start));
+        start = chrono::steady_clock::now();
+        tentative->status();
+        neighbor.add(elapsed(start));
+        delete tentative;
+    }
+    delete solution;
+    delete root;
+
+    vector<string> records;
+    records.push_back(parse.json("parse", instance));
+    records.push_back(build.json("build", instance));
+    records.push_back(status.json("status", instance));
+    records.push_back(clone.json("clone", instance));
+    records.push_back(relax.json("relax", instance));
+    records.push_back(constrain.json("constrain", instance));
+    records.push_back(neighbor.json("neighbor_status", instance));
+    return records;
+}
+
+/** Run of the LNS with a fixed time budget on the instance and seed of the options, returns its JSON record */
+static string macro_benchmark(BenchmarkOptions& opt)
+{
+    Random::Seed(opt.seed());
+    LNSCBCTT* s = new LNSCBCTT(opt);
+    Search::Options so;
+    so.stop = new Search::TimeStop(static_cast<unsigned long int>(opt.budget() * 1000));
+
+    int cost = -1, violations = -1;
+    unsigned int solutions = 0;
+    double best = 0;
+    Search::Meta::LNSStatistics stats;
+    auto start = chrono::steady_clock::now();
+    {
+        LNS<BAB, LNSCBCTT> e(s, so, s->lns_options());
+        while (LNSCBCTT* solution = e.next())
+        {
+            best = elapsed(start);
+            cost = solution->cost().val();
+            violations = solution->violations();
+            solutions++;
+            delete solution;
+        }
+        stats = e.lns_statistics();
+    }
+    delete s;
+    delete so.stop;
+
+    ostringstream os;
+    os << "{\"instance\": " << quote(opt.instance()) << ", \"seed\": " << opt.seed() << ", \"budget_s\": " << opt.budget()
+       << ", \"cost\": " << cost << ", \"violations\": " << violations << ", \"solutions\": " << solutions
+       << ", \"time_to_best_s\": " << best / 1000 << ", \"neighbors\": " << stats.neighbors
+       << ", \"neighbors_per_s\": " << stats.throughput() << ", \"improvements\": " << stats.improvements << "}";
+    return os.str();
+}
+
+/** Comma separated JSON records, one per line */
+static void print(ostream& os, const vector<string>& records)
+{
+    for (unsigned int i = 0; i < records.size(); i++)
+        os << "    " << records[i] << (i + 1 < records.size() ? "," : "") << endl;
+}
+
+int main(int argc, char * argv[])
+{
+    BenchmarkOptions opt("");
+    opt.model(0, "debug", "debug model (print lots of stuff)");
+    opt.model(1, "experiments", "silent model only prints a solution in the end");
+    opt.model(1);
+    opt.parse(argc, argv);
+
+    try
+    {
+        vector<string> instances;
+        if (opt.instances() != NULL)
+            instances = instance_files(opt.instances());
+        else
+            instances.push_back(opt.instance());
+
+        vector<string> micro_records, macro_records;
+        for (unsigned int i = 0; i < instances.size(); i++)
+        {
+            opt.instance(instances[i].c_str());
+            if (opt.repetitions() > 0)
+            {
+                Random::Seed(opt.seed());
+                vector<string> records = micro_benchmarks(opt);
+                micro_records.insert(micro_records.end(), records.begin(), records.end());
+            }
+            unsigned int seed = opt.seed();
+            for (unsigned int k = 0; k < opt.seeds(); k++)
+            {
+                opt.seed(seed + k);
+                cerr << "Benchmark: " << instances[i] << ", seed " << opt.seed() << endl;
+                macro_records.push_back(macro_benchmark(opt));
+            }
+            opt.seed(seed);
+        }
+
+        ofstream file;
+        if (opt.json() != NULL)
+            file.open(opt.json());
+        ostream& os = opt.json() != NULL ? file : cout;
+        os << "{" << endl;
+        os << "  \"label\": " << quote(opt.label() != NULL ? opt.label() : "") << "," << endl;
+        os << "  \"micro\": [" << endl;
+        print(os, micro_records);
+        os << "  ]," << endl;
+        os << "  \"macro\": [" << endl;
+        print(os, macro_records);
+        os << "  ]" << endl;
+        os << "}" << endl;
+    }
+    catch (std::exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,554 @@
+#include "../CBCTT.hh"
+#include "bench.hh"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cerrno>
+#include <sys/stat.h>
+
+using namespace std;
+
+/**
+ Tuning of the numeric parameters of the LNS by racing (F-race, see [Birattari et al.,
+ 2002](https://dl.acm.org/doi/10.5555/2955491.2955494)).
+
+ A set of candidate configurations (the options given, plus configurations sampled
+ uniformly, or log-uniformly, in the range of each parameter) is raced on the training
+ instances: at each step all the surviving candidates are run on a new block (the next
+ instance, with a new seed once all of them have been used), each run in its own process
+ and as many runs as requested in parallel. Once enough blocks have been run, candidates
+ are ranked on each block (by violations, then by cost), and whenever the Friedman test
+ rejects the hypothesis that all of them perform alike, the candidates whose rank sum is
+ significantly worse than the best one (Conover's post-hoc test) are eliminated. The race
+ ends when one candidate survives, or when the runs are exhausted, and the surviving
+ candidate with the best rank sum is the tuned option set.
+
+ The parameters of the simulated annealing are only meaningful when the race is run
+ with -lns_constrain_type sa.
+
+ The best surviving candidate on each training instance is also recorded along with the
+ features of the instance (see Faculty::PrintStatistics), so that an unseen instance can
+ be given the configuration of the closest training instance (-tune_mapping).
+ */
+class TuneOptions : public CBCTTOptions
+{
+public:
+
+    TuneOptions(const char* p) : CBCTTOptions(p),
+    _instances("-tune_instances", "directory of training instances (.ctt/.ectt) (default: the -instance one)"),
+    _candidates("-tune_candidates", "number of candidate configurations, including the options given", 32),
+    _budget("-tune_budget", "time budget of each run (s)", 10),
+    _max_runs("-tune_max_runs", "maximum number of runs of the race", 1000),
+    _first_test("-tune_first_test", "number of blocks run before the first elimination test", 5),
+    _alpha("-tune_alpha", "significance level of the elimination tests", 0.05),
+    _jobs("-tune_jobs", "number of runs carried out in parallel (0: one per core)", 0),
+    _output("-tune_output", "directory the results of the runs, the tuned option set and the feature mapping are written to", "tune"),
+    _mapping("-tune_mapping", "instead of racing, print the configuration of the training instance closest to -instance in this feature mapping")
+    {
+        add(_instances);
+        add(_candidates);
+        add(_budget);
+        add(_max_runs);
+        add(_first_test);
+        add(_alpha);
+        add(_jobs);
+        add(_output);
+        add(_mapping);
+    }
+
+    const char* instances(void) const { return _instances.value(); }
+    unsigned int candidates(void) const { return _candidates.value(); }
+    double budget(void) const { return _budget.value(); }
+    unsigned int maxRuns(void) const { return _max_runs.value(); }
+    unsigned int firstTest(void) const { return _first_test.value(); }
+    double alpha(void) const { return _alpha.value(); }
+    unsigned int jobs(void) const { return _jobs.value(); }
+    const char* output(void) const { return _output.value(); }
+    const char* mapping(void) const { return _mapping.value(); }
+
+protected:
+
+    Driver::StringValueOption _instances;
+    Driver::UnsignedIntOption _candidates;
+    Driver::DoubleOption _budget;
+    Driver::UnsignedIntOption _max_runs;
+    Driver::UnsignedIntOption _first_test;
+    Driver::DoubleOption _alpha;
+    Driver::UnsignedIntOption _jobs;
+    Driver::StringValueOption _output;
+    Driver::StringValueOption _mapping;
+};
+
+/** A numeric parameter of the LNS, and the range it is tuned in */
+struct Parameter
+{
+    const char* option;
+    double min, max;
+    bool integer, logarithmic;
+};
+
+static const Parameter parameters[] = {
+    { "-lns_time_per_variable", 1, 100, false, true },
+    { "-lns_max_iterations_per_intensity", 1, 100, true, true },
+    { "-lns_min_intensity", 1, 20, true, false },
+    { "-lns_max_intensity", 2, 60, true, false },
+    { "-lns_sa_start_temperature", 0.1, 100, false, true },
+    { "-lns_sa_cooling_rate", 0.9, 0.9999, false, false },
+    { "-lns_sa_neighbors_accepted", 10, 1000, true, true },
+    { "-lns_sa_target_acceptance", 0, 0.5, false, false }
+};
+
+static const unsigned int PARAMETERS = sizeof(parameters) / sizeof(Parameter);
+
+/** Options of a configuration */
+static vector<string> configuration_options(const vector<double>& values)
+{
+    vector<string> options;
+    for (unsigned int i = 0; i < PARAMETERS; i++)
+    {
+        ostringstream v;
+        if (parameters[i].integer)
+            v << (long int) values[i];
+        else
+            v << setprecision(6) << values[i];
+        options.push_back(parameters[i].option);
+        options.push_back(v.str());
+    }
+    return options;
+}
+
+/** Random configuration */
+static vector<double> sample()
+{
+    vector<double> values(PARAMETERS);
+    for (unsigned int i = 0; i < PARAMETERS; i++)
+    {
+        const Parameter& p = parameters[i];
+        if (p.logarithmic)
+            values[i] = exp(Random::Double(log(p.min), log(p.max)));
+        else
+            values[i] = Random::Double(p.min, p.max);
+        if (p.integer)
+            values[i] = floor(values[i] + 0.5);
+    }
+    // The maximum intensity is not smaller than the minimum one
+    values[3] = max(values[3], values[2]);
+    return values;
+}
+
+/** Features of an instance, i.e., the "Features:" line of its statistics (printed along with the instance) */
+static vector<double> features(const Faculty& in)
+{
+    ostringstream os;
+    os << in;
+    istringstream is(os.str());
+    string line;
+    vector<double> f;
+    while (getline(is, line))
+        if (line.compare(0, 9, "Features:") == 0)
+        {
+            istringstream ls(line.substr(9));
+            string v;
+            while (getline(ls, v, ','))
+                f.push_back(stod(v));
+        }
+    return f;
+}
+
+/** Quantile of the standard normal distribution (Acklam's algorithm) */
+static double normal_quantile(double p)
+{
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+    if (p < 0.02425)
+    {
+        double q = sqrt(-2 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - 0.02425)
+        return -normal_quantile(1 - p);
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/** Quantile of the chi-squared distribution with df degrees of freedom (Wilson-Hilferty approximation) */
+static double chi_squared_quantile(double p, double df)
+{
+    double h = 2 / (9 * df);
+    return df * pow(max(0.0, 1 - h + normal_quantile(p) * sqrt(h)), 3);
+}
+
+/** Quantile of Student's t distribution with df degrees of freedom (Cornish-Fisher expansion) */
+static double t_quantile(double p, double df)
+{
+    double z = normal_quantile(p), z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df);
+}
+
+/** Race of the candidate configurations */
+class Race
+{
+public:
+
+    Race(const TuneOptions& opt, const vector<string>& args, const vector<string>& instances) :
+        opt(opt), args(args), instances(instances), runs(0)
+    {
+        Random::Seed(opt.seed());
+        candidates.push_back(vector<double>(PARAMETERS));
+        vector<double>& given = candidates[0];
+        given[0] = opt.timePerVariable();
+        given[1] = opt.maxIterationsPerIntensity();
+        given[2] = opt.minIntensity();
+        given[3] = opt.maxIntensity();
+        given[4] = opt.SAstartTemperature();
+        given[5] = opt.SAcoolingRate();
+        given[6] = opt.SAneighborsAccepted();
+        given[7] = opt.SAtargetAcceptance();
+        while (candidates.size() < max(1u, opt.candidates()))
+            candidates.push_back(sample());
+        alive.assign(candidates.size(), true);
+    }
+
+    /** Run the race, returns the index of the best surviving candidate */
+    unsigned int run()
+    {
+        unsigned int survivors = candidates.size();
+        while (survivors > 1 && runs + survivors <= opt.maxRuns())
+        {
+            block();
+            survivors = std::count(alive.begin(), alive.end(), true);
+            cerr << "Tune: block " << results.size() << " (" << instance_name(instances[(results.size() - 1) % instances.size()])
+                 << "), " << runs << " runs, " << survivors << " candidates alive" << endl;
+            if (results.size() >= opt.firstTest())
+                test();
+            survivors = std::count(alive.begin(), alive.end(), true);
+        }
+        vector<double> r = rank_sums();
+        unsigned int best = 0;
+        while (!alive[best])
+            best++;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c] && r[c] < r[best])
+                best = c;
+        return best;
+    }
+
+    /** Options of a candidate */
+    vector<string> options(unsigned int c) const
+    {
+        return configuration_options(candidates[c]);
+    }
+
+    /** Best surviving candidate on the blocks of an instance (or the given one, if none) */
+    unsigned int best_on(unsigned int instance, unsigned int winner) const
+    {
+        vector<double> r(candidates.size(), 0);
+        bool any = false;
+        for (unsigned int b = instance; b < results.size(); b += instances.size())
+        {
+            vector<double> rb = ranks(b);
+            for (unsigned int c = 0; c < candidates.size(); c++)
+                r[c] += rb[c];
+            any = true;
+        }
+        if (!any)
+            return winner;
+        unsigned int best = winner;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c] && r[c] < r[best])
+                best = c;
+        return best;
+    }
+
+protected:
+
+    /** Run the surviving candidates on the next block */
+    void block()
+    {
+        unsigned int b = results.size();
+        const string instance = instances[b % instances.size()];
+        const unsigned int seed = opt.seed() + b / instances.size();
+        vector<unsigned int> racing;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c])
+                racing.push_back(c);
+        results.push_back(vector<pair<int, int> >(candidates.size(), make_pair(-1, -1)));
+
+        run_processes(racing.size(), opt.jobs(),
+            [&](unsigned int i)
+            {
+                vector<string> a = args;
+                vector<string> o = options(racing[i]);
+                a.insert(a.end(), o.begin(), o.end());
+                a.push_back("-instance");
+                a.push_back(instance);
+                a.push_back("-seed");
+                a.push_back(to_string(seed));
+                return solve(a, result_file(racing[i], b));
+            },
+            [&](unsigned int i, int status)
+            {
+                if (status != 0)
+                    cerr << "Tune: run of candidate " << racing[i] << " on block " << b << " failed" << endl;
+            });
+        runs += racing.size();
+
+        // A failed run is the worst one
+        for (unsigned int i = 0; i < racing.size(); i++)
+        {
+            ifstream is(result_file(racing[i], b).c_str());
+            int violations, cost;
+            if (is >> violations >> cost)
+                results[b][racing[i]] = make_pair(violations, cost);
+            else
+                results[b][racing[i]] = make_pair(INT_MAX, INT_MAX);
+        }
+    }
+
+    /** File the result of the run of a candidate on a block is written to */
+    string result_file(unsigned int c, unsigned int b) const
+    {
+        return string(opt.output()) + "/" + to_string(c) + "." + to_string(b) + ".result";
+    }
+
+    /** Run the solver (in a child process) with a command line, write the violations and the cost of the best solution */
+    static int solve(const vector<string>& args, const string& result)
+    {
+        TuneOptions opt("");
+        parse(opt, args);
+        Random::Seed(opt.seed());
+        LNSCBCTT* s = new LNSCBCTT(opt);
+        Search::Options so;
+        so.stop = new Search::TimeStop(static_cast<unsigned long int>(opt.budget() * 1000));
+        int violations = INT_MAX, cost = INT_MAX;
+        {
+            LNS<BAB, LNSCBCTT> e(s, so, s->lns_options());
+            while (LNSCBCTT* solution = e.next())
+            {
+                violations = solution->violations();
+                cost = solution->cost().val();
+                delete solution;
+            }
+        }
+        delete s;
+        delete so.stop;
+        ofstream os(result.c_str());
+        os << violations << " " << cost << endl;
+        return 0;
+    }
+
+    /** Ranks of the surviving candidates on a block (ties get the average rank, the others 0) */
+    vector<double> ranks(unsigned int b) const
+    {
+        vector<unsigned int> racing;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c])
+                racing.push_back(c);
+        sort(racing.begin(), racing.end(), [&](unsigned int c1, unsigned int c2) { return results[b][c1] < results[b][c2]; });
+        vector<double> r(candidates.size(), 0);
+        for (unsigned int i = 0; i < racing.size(); )
+        {
+            unsigned int j = i;
+            while (j < racing.size() && results[b][racing[j]] == results[b][racing[i]])
+                j++;
+            for (unsigned int k = i; k < j; k++)
+                r[racing[k]] = (i + 1 + j) / 2.0;
+            i = j;
+        }
+        return r;
+    }
+
+    /** Rank sums of the surviving candidates on all the blocks */
+    vector<double> rank_sums() const
+    {
+        vector<double> r(candidates.size(), 0);
+        for (unsigned int b = 0; b < results.size(); b++)
+        {
+            vector<double> rb = ranks(b);
+            for (unsigned int c = 0; c < candidates.size(); c++)
+                r[c] += rb[c];
+        }
+        return r;
+    }
+
+    /** Friedman test, and elimination of the candidates worse than the best one (Conover's post-hoc test) */
+    void test()
+    {
+        double m = results.size(), k = std::count(alive.begin(), alive.end(), true);
+        if (k < 2)
+            return;
+        vector<double> r = rank_sums();
+        double squares = 0;
+        for (unsigned int b = 0; b < results.size(); b++)
+        {
+            vector<double> rb = ranks(b);
+            for (unsigned int c = 0; c < candidates.size(); c++)
+                squares += rb[c] * rb[c];
+        }
+        double a = squares - m * k * (k + 1) * (k + 1) / 4, deviation = 0;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c])
+                deviation += (r[c] - m * (k + 1) / 2) * (r[c] - m * (k + 1) / 2);
+        if (a <= 0)
+            return; // all the candidates tie on every block
+        double t = (k - 1) * deviation / a;
+        if (t <= chi_squared_quantile(1 - opt.alpha(), k - 1))
+            return;
+
+        unsigned int best = 0;
+        while (!alive[best])
+            best++;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c] && r[c] < r[best])
+                best = c;
+        double df = (m - 1) * (k - 1);
+        double difference = t_quantile(1 - opt.alpha() / 2, df) * sqrt(2 * m * a * (1 - t / (m * (k - 1))) / df);
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            if (alive[c] && r[c] - r[best] > difference)
+                alive[c] = false;
+    }
+
+    const TuneOptions& opt;
+
+    /** Command line of the tuner (the runs add the options of their candidate) */
+    const vector<string>& args;
+
+    const vector<string>& instances;
+
+    /** Values of the parameters of each candidate */
+    vector<vector<double> > candidates;
+
+    /** Whether each candidate is still in the race */
+    vector<bool> alive;
+
+    /** Violations and cost of each candidate on each block (-1 if not run) */
+    vector<vector<pair<int, int> > > results;
+
+    /** Runs carried out */
+    unsigned int runs;
+};
+
+/** Print the options of the training instance closest to an instance in a feature mapping */
+static void select_configuration(const TuneOptions& opt)
+{
+    ifstream is(opt.mapping());
+    if (!is)
+        throw runtime_error(string("Cannot open feature mapping ") + opt.mapping());
+    vector<vector<double> > f;
+    vector<string> options;
+    string line;
+    while (getline(is, line))
+    {
+        // instance features options...
+        istringstream ls(line);
+        string name, values;
+        if (!(ls >> name >> values) || name[0] == '#')
+            continue;
+        istringstream vs(values);
+        string v;
+        f.push_back(vector<double>());
+        while (getline(vs, v, ','))
+            f.back().push_back(stod(v));
+        getline(ls, line);
+        options.push_back(line);
+    }
+    if (f.empty())
+        throw runtime_error(string("Empty feature mapping ") + opt.mapping());
+
+    // Nearest neighbor, each feature being scaled by its standard deviation on the training instances
+    vector<double> x = features(Faculty(opt.instance()));
+    vector<double> scale(x.size(), 0);
+    for (unsigned int j = 0; j < x.size(); j++)
+    {
+        double mean = 0, variance = 0;
+        for (unsigned int i = 0; i < f.size(); i++)
+            mean += f[i][j] / f.size();
+        for (unsigned int i = 0; i < f.size(); i++)
+            variance += (f[i][j] - mean) * (f[i][j] - mean) / f.size();
+        scale[j] = variance > 0 ? 1 / sqrt(variance) : 0;
+    }
+    unsigned int closest = 0;
+    double closest_distance = INFINITY;
+    for (unsigned int i = 0; i < f.size(); i++)
+    {
+        double distance = 0;
+        for (unsigned int j = 0; j < x.size() && j < f[i].size(); j++)
+            distance += (x[j] - f[i][j]) * (x[j] - f[i][j]) * scale[j] * scale[j];
+        if (distance < closest_distance)
+        {
+            closest = i;
+            closest_distance = distance;
+        }
+    }
+    cout << options[closest].substr(options[closest].find_first_not_of(' ')) << endl;
+}
+
+int main(int argc, char * argv[])
+{
+    // The runs are given the same command line, followed by the options of their candidate
+    vector<string> args(argv, argv + argc);
+    TuneOptions opt("");
+    parse(opt, args);
+
+    try
+    {
+        if (opt.mapping() != NULL)
+        {
+            select_configuration(opt);
+            return 0;
+        }
+
+        vector<string> instances;
+        if (opt.instances() != NULL)
+            instances = instance_files(opt.instances());
+        else
+            instances.push_back(opt.instance());
+        if (instances.empty())
+            throw runtime_error("No training instances");
+        const string output = opt.output();
+        if (mkdir(output.c_str(), 0755) != 0 && errno != EEXIST)
+            throw runtime_error("Cannot create directory " + output);
+
+        Race race(opt, args, instances);
+        unsigned int winner = race.run();
+
+        // The tuned option set, as a parameter set of the anytime harness
+        vector<string> tuned = race.options(winner);
+        ofstream os((output + "/tuned.txt").c_str());
+        os << "tuned";
+        cout << "Tuned options:";
+        for (unsigned int i = 0; i < tuned.size(); i++)
+        {
+            os << " " << tuned[i];
+            cout << " " << tuned[i];
+        }
+        os << endl;
+        cout << endl;
+
+        // The best surviving candidate on each training instance, with the features of the instance
+        ofstream mapping((output + "/mapping.txt").c_str());
+        for (unsigned int i = 0; i < instances.size(); i++)
+        {
+            vector<double> f = features(Faculty(instances[i]));
+            mapping << instance_name(instances[i]) << " ";
+            for (unsigned int j = 0; j < f.size(); j++)
+                mapping << (j > 0 ? "," : "") << f[j];
+            vector<string> o = race.options(race.best_on(i, winner));
+            for (unsigned int j = 0; j < o.size(); j++)
+                mapping << " " << o[j];
+            mapping << endl;
+        }
+    }
+    catch (std::exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "construction.hh"
+#include "random.hh"
+#include <algorithm>
+#include <climits>
+#include <tuple>
+
+Construction::Construction(const Faculty& in) : in(in), _violations(0)
+{
+    first_lecture.resize(in.Courses());
+    for (unsigned int c = 0, l = 0; c < in.Courses(); c++)
+    {
+        first_lecture[c] = l;
+        l += in.CourseVector(c).Lectures();
+    }
+}
+
+vector<int> Construction::build(unsigned long int tabu_iterations)
+{
+    unsigned int lectures = in.TotalLectures();
+    blocked.assign(in.Courses(), vector<unsigned int>(in.Periods(), 0));
+    days.assign(in.Courses(), vector<unsigned int>(in.Days(), 0));
+    booked.assign(in.Periods(), 0);
+    period.assign(lectures, 0);
+    scheduled.assign(in.Courses(), 0);
+    _violations = 0;
+
+    // Number of lectures the greedy could only schedule by violating a constraint
+    unsigned int forced = 0;
+    for (unsigned int k = 0; k < lectures; k++)
+    {
+        // Most constrained course first (fewest free periods, then most conflicting courses)
+        unsigned int next = in.Courses(), next_free = UINT_MAX, next_degree = 0, ties = 0;
+        for (unsigned int c = 0; c < in.Courses(); c++)
+        {
+            if (scheduled[c] == in.CourseVector(c).Lectures())
+                continue;
+            unsigned int free = 0;
+            for (unsigned int p = 0; p < in.Periods(); p++)
+                if (in.Available(c, p) && blocked[c][p] == 0 && booked[p] < in.Rooms())
+                    free++;
+            unsigned int degree = in.CourseConflicts(c);
+            if (free < next_free || (free == next_free && degree > next_degree))
+            {
+                next = c;
+                next_free = free;
+                next_degree = degree;
+                ties = 1;
+            }
+            else if (free == next_free && degree == next_degree && Random::Int(0, ties++) == 0)
+                next = c;
+        }
+
+        unsigned int p;
+        if (!choose_period(next, p))
+            forced++;
+
+        period[first_lecture[next] + scheduled[next]++] = p;
+        booked[p]++;
+        blocked[next][p]++;
+        days[next][p / in.PeriodsPerDay()]++;
+        for (unsigned int a = 0; a < in.CourseConflicts(next); a++)
+            blocked[in.CourseConflict(next, a)][p]++;
+    }
+
+    // Repair the periods (or just count their violations), unless the greedy never had to violate a constraint
+    if (forced > 0)
+    {
+        Tabucol tabucol(in);
+        _violations = tabucol.run(period, tabu_iterations);
+    }
+
+    // Lectures of the same course in increasing periods (symmetry breaking of the model)
+    for (unsigned int c = 0; c < in.Courses(); c++)
+        sort(period.begin() + first_lecture[c], period.begin() + first_lecture[c] + in.CourseVector(c).Lectures());
+
+    vector<int> roomslot(lectures);
+    assign_rooms(roomslot);
+    return roomslot;
+}
+
+bool Construction::choose_period(unsigned int c, unsigned int& chosen) const
+{
+    // Free periods, preferring days the course is not yet taught and periods with more free rooms
+    unsigned int best = in.Periods(), best_score = UINT_MAX, ties = 0;
+    for (unsigned int p = 0; p < in.Periods(); p++)
+    {
+        if (!in.Available(c, p) || blocked[c][p] > 0 || booked[p] >= in.Rooms())
+            continue;
+        unsigned int score = days[c][p / in.PeriodsPerDay()] * in.Rooms() + booked[p];
+        if (score < best_score)
+        {
+            best = p;
+            best_score = score;
+            ties = 1;
+        }
+        else if (score == best_score && Random::Int(0, ties++) == 0)
+            best = p;
+    }
+    if (best < in.Periods())
+    {
+        chosen = best;
+        return true;
+    }
+
+    // Otherwise the available period with the fewest conflicts and overlaps (but never twice the same period for a course)
+    vector<bool> taken(in.Periods(), false);
+    for (unsigned int l = first_lecture[c]; l < first_lecture[c] + scheduled[c]; l++)
+        taken[period[l]] = true;
+    best = 0;
+    best_score = UINT_MAX;
+    ties = 0;
+    for (unsigned int p = 0; p < in.Periods(); p++)
+    {
+        if (taken[p])
+            continue;
+        unsigned int score = blocked[c][p] + (booked[p] >= in.Rooms() ? 1 : 0) + (in.Available(c, p) ? 0 : in.TotalLectures() + 1);
+        if (score < best_score)
+        {
+            best = p;
+            best_score = score;
+            ties = 1;
+        }
+        else if (score == best_score && Random::Int(0, ties++) == 0)
+            best = p;
+    }
+    chosen = best;
+    return false;
+}
+
+void Construction::assign_rooms(vector<int>& roomslot) const
+{
+    // Rooms already used by each course (for room stability)
+    vector<vector<bool> > used(in.Courses(), vector<bool>(in.Rooms(), false));
+    vector<unsigned int> course(in.TotalLectures());
+    for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int l = first_lecture[c]; l < first_lecture[c] + in.CourseVector(c).Lectures(); l++)
+            course[l] = c;
+
+    vector<vector<unsigned int> > lectures_in(in.Periods());
+    for (unsigned int l = 0; l < in.TotalLectures(); l++)
+        lectures_in[period[l]].push_back(l);
+
+    for (unsigned int p = 0; p < in.Periods(); p++)
+    {
+        // Largest courses first, so that they get the large rooms
+        vector<unsigned int>& lectures = lectures_in[p];
+        stable_sort(lectures.begin(), lectures.end(), [&](unsigned int l1, unsigned int l2) {
+            return in.CourseVector(course[l1]).Students() > in.CourseVector(course[l2]).Students();
+        });
+
+        vector<bool> free(in.Rooms(), true);
+        for (unsigned int i = 0; i < lectures.size(); i++)
+        {
+            unsigned int c = course[lectures[i]], students = in.CourseVector(c).Students();
+            // Free rooms first, then large enough ones, then rooms already used by the course,
+            // then the smallest large enough room (or the largest one if none is large enough)
+            unsigned int best = 0;
+            tuple<bool, bool, bool, long> best_score;
+            for (unsigned int r = 0; r < in.Rooms(); r++)
+            {
+                long capacity = in.RoomVector(r + 1).Capacity();
+                bool fits = capacity >= students;
+                tuple<bool, bool, bool, long> score(!free[r], !fits, !used[c][r], fits ? capacity : -capacity);
+                if (r == 0 || score < best_score)
+                {
+                    best = r;
+                    best_score = score;
+                }
+            }
+            free[best] = false;
+            used[c][best] = true;
+            roomslot[lectures[i]] = p * in.Rooms() + best;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef CP_CTT_construction_hh
+#define CP_CTT_construction_hh
+
+#include "faculty.hh"
+#include "feasibility.hh"
+#include <vector>
+
+using namespace std;
+
+/**
+ Greedy constructive heuristic for CB-CTT, working directly on the Faculty.
+
+ Periods are assigned DSatur-style: the course with the fewest periods still
+ free from conflicts, unavailabilities and fully booked rooms is scheduled
+ first (ties broken by the number of conflicting courses, then at random),
+ spreading its lectures over different days. Then, period by period, rooms
+ are assigned to lectures by decreasing number of students, preferring the
+ room already used by the course and the smallest room which is large enough.
+
+ Lectures are numbered as in the CP model (all the lectures of course 0, then
+ those of course 1, ...), and the lectures of each course are in increasing
+ periods, so that the result satisfies the symmetry breaking of the model.
+ 
+ If the greedy periods have hard violations, they can be repaired by tabu
+ search (see feasibility.hh) before the rooms are assigned.
+ */
+class Construction
+{
+public:
+
+    /** Constructor
+     *  @param in instance
+     */
+    Construction(const Faculty& in);
+
+    /** Build a timetable, returns the roomslot (period * rooms + room) of each lecture
+     *  @param tabu_iterations maximum number of iterations of the tabu search repairing the periods
+     */
+    vector<int> build(unsigned long int tabu_iterations = 0);
+
+    /** Hard violations of the periods of the last timetable (see Tabucol) */
+    unsigned int violations() const
+    {
+        return _violations;
+    }
+
+protected:
+
+    /** Choose the period of the next lecture of course c, returns false if it has to violate a constraint */
+    bool choose_period(unsigned int c, unsigned int& chosen) const;
+
+    /** Assign the rooms to the lectures scheduled in each period */
+    void assign_rooms(vector<int>& roomslot) const;
+
+    const Faculty& in;
+
+    /** For each course and period, the number of lectures of conflicting courses (or of the course itself) */
+    vector<vector<unsigned int> > blocked;
+
+    /** For each course and day, the number of lectures of the course */
+    vector<vector<unsigned int> > days;
+
+    /** Number of lectures in each period */
+    vector<unsigned int> booked;
+
+    /** Period of each lecture */
+    vector<unsigned int> period;
+
+    /** Number of lectures of each course which have already been scheduled */
+    vector<unsigned int> scheduled;
+
+    /** Index of the first lecture of each course */
+    vector<unsigned int> first_lecture;
+
+    unsigned int _violations;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef CP_CTT_costs_hh
+#define CP_CTT_costs_hh
+
+/** Weights of the cost components of CB-CTT (shared by the CP model and the local search) */
+#define ROOM_CAPACITY_COST 1            // per standing student
+#define MINIMUM_WORKING_DAYS_COST 5     // per day below minimum
+#define CURRICULUM_COMPACTNESS_COST 2   // per non-adjacent lectures in same day
+#define ROOM_STABILITY_COST 1           // per extra room used for the lectures of a course
+
+#endif
@@ -0,0 +1,118 @@
+#include "feasibility.hh"
+#include "random.hh"
+#include <climits>
+
+Tabucol::Tabucol(const Faculty& in) : in(in), violations(0), _iterations(0)
+{
+    for (unsigned int c = 0; c < in.Courses(); c++)
+        for (unsigned int i = 0; i < in.CourseVector(c).Lectures(); i++)
+            course.push_back(c);
+}
+
+int Tabucol::delta(unsigned int l, unsigned int p, unsigned int q) const
+{
+    unsigned int c = course[l];
+    int d = (int) conflicting[c][q] - ((int) conflicting[c][p] - 1);
+    if (booked[p] > in.Rooms())
+        d--;
+    if (booked[q] >= in.Rooms())
+        d++;
+    if (!in.Available(c, p))
+        d--;
+    if (!in.Available(c, q))
+        d++;
+    return d;
+}
+
+void Tabucol::move(unsigned int l, unsigned int q, vector<unsigned int>& period)
+{
+    unsigned int c = course[l], p = period[l];
+    violations += delta(l, p, q);
+    period[l] = q;
+    booked[p]--;
+    booked[q]++;
+    conflicting[c][p]--;
+    conflicting[c][q]++;
+    for (unsigned int a = 0; a < in.CourseConflicts(c); a++)
+    {
+        conflicting[in.CourseConflict(c, a)][p]--;
+        conflicting[in.CourseConflict(c, a)][q]++;
+    }
+}
+
+unsigned int Tabucol::run(vector<unsigned int>& period, unsigned long int max_iterations)
+{
+    unsigned int lectures = course.size();
+    conflicting.assign(in.Courses(), vector<unsigned int>(in.Periods(), 0));
+    booked.assign(in.Periods(), 0);
+    tabu.assign(lectures, vector<unsigned long int>(in.Periods(), 0));
+
+    // Initial violations
+    violations = 0;
+    for (unsigned int l = 0; l < lectures; l++)
+    {
+        unsigned int c = course[l], p = period[l];
+        violations += conflicting[c][p]; // pairs with the lectures counted so far
+        if (booked[p] >= in.Rooms())
+            violations++;
+        if (!in.Available(c, p))
+            violations++;
+        booked[p]++;
+        conflicting[c][p]++;
+        for (unsigned int a = 0; a < in.CourseConflicts(c); a++)
+            conflicting[in.CourseConflict(c, a)][p]++;
+    }
+
+    vector<unsigned int> best = period;
+    int best_violations = violations;
+
+    for (_iterations = 0; _iterations < max_iterations && best_violations > 0; _iterations++)
+    {
+        // Best move of a violating lecture (non tabu, or leading to a new best assignment)
+        unsigned int move_lecture = lectures, move_period = 0, ties = 0;
+        int move_delta = INT_MAX;
+        for (unsigned int l = 0; l < lectures; l++)
+        {
+            unsigned int c = course[l], p = period[l];
+            if (conflicting[c][p] <= 1 && booked[p] <= in.Rooms() && in.Available(c, p))
+                continue;
+            for (unsigned int q = 0; q < in.Periods(); q++)
+            {
+                if (q == p || !in.Available(c, q))
+                    continue;
+                int d = delta(l, p, q);
+                if (tabu[l][q] > _iterations && violations + d >= best_violations)
+                    continue;
+                if (d < move_delta)
+                {
+                    move_lecture = l;
+                    move_period = q;
+                    move_delta = d;
+                    ties = 1;
+                }
+                else if (d == move_delta && Random::Int(0, ties++) == 0)
+                {
+                    move_lecture = l;
+                    move_period = q;
+                }
+            }
+        }
+
+        // All the moves are tabu
+        if (move_lecture == lectures)
+            continue;
+
+        unsigned int p = period[move_lecture];
+        move(move_lecture, move_period, period);
+        tabu[move_lecture][p] = _iterations + 1 + Random::Int(0, 9) + (unsigned long int) (0.6 * violations);
+
+        if (violations < best_violations)
+        {
+            best = period;
+            best_violations = violations;
+        }
+    }
+
+    period = best;
+    return best_violations;
+}
@@ -0,0 +1,75 @@
+#ifndef CP_CTT_feasibility_hh
+#define CP_CTT_feasibility_hh
+
+#include "faculty.hh"
+#include <vector>
+
+using namespace std;
+
+/**
+ Tabu search for the feasibility of a CB-CTT period assignment (Tabucol,
+ Hertz and de Werra, 1987), working directly on the Faculty.
+
+ The lecture-period assignment is seen as a coloring of the conflict graph
+ of the lectures (lectures of the same course or of conflicting courses),
+ where each period can be used by at most as many lectures as there are
+ rooms, so that rooms can always be matched afterwards. Violations are the
+ pairs of conflicting lectures in the same period, the lectures in excess of
+ the rooms of a period, and the lectures in unavailable periods.
+
+ At each iteration, a violating lecture is moved to the period which reduces
+ the violations the most, among the moves which are not tabu (or which lead
+ to the best assignment found so far). Moving a lecture back to a period it
+ has just left is tabu for a number of iterations which grows with the
+ number of violations.
+ */
+class Tabucol
+{
+public:
+
+    /** Constructor
+     *  @param in instance
+     */
+    Tabucol(const Faculty& in);
+
+    /** Search from the given periods (one per lecture, numbered as in the CP model) until there are no
+     *  violations or max_iterations have been done, leaves the best periods found in place
+     *  @return the number of violations of the best periods
+     */
+    unsigned int run(vector<unsigned int>& period, unsigned long int max_iterations);
+
+    /** Number of iterations of the last run */
+    unsigned long int iterations() const
+    {
+        return _iterations;
+    }
+
+protected:
+
+    /** Variation of the violations if lecture l is moved from period p to period q */
+    int delta(unsigned int l, unsigned int p, unsigned int q) const;
+
+    /** Move lecture l to period p */
+    void move(unsigned int l, unsigned int p, vector<unsigned int>& period);
+
+    const Faculty& in;
+
+    /** Course of each lecture */
+    vector<unsigned int> course;
+
+    /** For each course and period, the number of lectures of the course and of conflicting courses */
+    vector<vector<unsigned int> > conflicting;
+
+    /** Number of lectures in each period */
+    vector<unsigned int> booked;
+
+    /** For each lecture and period, the first iteration moving the lecture back to the period is allowed */
+    vector<vector<unsigned long int> > tabu;
+
+    /** Current number of violations */
+    int violations;
+
+    unsigned long int _iterations;
+};
+
+#endif
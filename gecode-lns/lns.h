@@ -2,6 +2,14 @@
 #define _LNS_H
 
 #include <gecode/kernel.hh>
+#include <gecode/search.hh>
+#include <vector>
+#include "lns_options.h"
+
+namespace Gecode { namespace Search { namespace Meta {
+  class LNSIncumbent;
+  class LNSStatistics;
+}}}
 
 namespace Gecode {
 
@@ -17,22 +25,29 @@ namespace Gecode {
   template<template<class> class E, class T>
   class LNS : public EngineBase {
   public:
-    /// Initialize engine for space \a s and options \a o
-    LNS(T* s, const Search::Options& o);
+    /// Initialize engine for space \a s, search options \a o and LNS parameters \a lo
+    LNS(T* s, const Search::Options& o, const LNSBaseOptions& lo);
     ~LNS(void);
     /// Return next solution (NULL, if non exists or search has been stopped)
     T* next(void);
     /// Return statistics
     Search::Statistics stats;
     Search::Statistics statistics(void) const;
+    /// Return LNS specific statistics
+    Search::Meta::LNSStatistics lns_statistics(void) const;
     /// Check whether engine has been stopped
     bool stopped(void) const;
   
   protected:
     Space* root;
-    E<T>* engine;
-    E<T>* start_engine;
+    /// The stop objects of the sub-engines (they are not deleted by the engines)
+    std::vector<Search::Stop*> stops;
     const Search::Options& opt;
+    /// The LNS parameters (copied, they do not change during the run)
+    const LNSParameters lns_opt;
+    /// Create an LNS meta-engine running on root space \a r
+    Search::Engine* meta(Space* r, Search::Statistics& st, const Search::Options& o,
+                         Search::Meta::LNSIncumbent* incumbent, unsigned int stream, unsigned int streams);
   };
 
   /**
@@ -54,7 +69,7 @@ namespace Gecode {
    * \ingroup TaskModelSearch
    */
   template<template<class> class E, class T>
-  T* lns(T* s, const Search::Options& o);
+  T* lns(T* s, const Search::Options& o, const LNSBaseOptions& lo);
 
 }
 
@@ -62,68 +77,111 @@ namespace Gecode {
 #include <gecode/driver.hh>
 
 namespace Gecode {
-  enum LNSConstrainType { LNS_CT_NONE, LNS_CT_LOOSE, LNS_CT_STRICT, LNS_CT_SA };
-  
-  class LNSBaseOptions
-  {
-  public:
-    virtual double timePerVariable(void) const = 0;
-    virtual void timePerVariable(double v) = 0;
-    
-    virtual LNSConstrainType constrainType(void) const = 0;
-    virtual void constrainType(LNSConstrainType v) = 0;
-    
-    virtual unsigned int maxIterationsPerIntensity(void) const = 0;
-    virtual void maxIterationsPerIntensity(unsigned int v) = 0;
-    
-    virtual unsigned int minIntensity(void) const = 0;
-    virtual void minIntensity(unsigned int v) = 0;
-    
-    virtual unsigned int maxIntensity(void) const = 0;
-    virtual void maxIntensity(unsigned int v) = 0;
-    
-    virtual double SAstartTemperature(void) const = 0;
-    virtual void SAstartTemperature(double v) = 0;
-    
-    virtual double SAcoolingRate(void) const = 0;
-    virtual void SAcoolingRate(double v) = 0;
-    
-    virtual unsigned int SAneighborsAccepted(void) const = 0;
-    virtual void SAneighborsAccepted(unsigned int v) = 0;   
-  };
-  
   template <class OptionsBase>
   class LNSOptions : public LNSBaseOptions, public OptionsBase {
   public:        
     LNSOptions(const char* p) : OptionsBase(p),
     _time_per_variable("-lns_time_per_variable", "LNS: the time to grant for neighborhood exploration to each relaxed variable (in milliseconds)", 10.0),
-    _constrain_type("-lns_constrain_type", "LNS: the type of constrain function to be applied to search (default: strict, other values: none, loose, sa)", LNS_CT_STRICT),
+    _budget_type("-lns_budget", "LNS: the resource bounding neighborhood exploration (default: time, other values: fails, nodes)", LNS_BT_TIME),
+    _fails_per_variable("-lns_fails_per_variable", "LNS: the failures to grant for neighborhood exploration to each relaxed variable", 50.0),
+    _nodes_per_variable("-lns_nodes_per_variable", "LNS: the nodes to grant for neighborhood exploration to each relaxed variable", 200.0),
+    _budget_adaptive("-lns_budget_adaptive", "LNS: adapt the neighborhood exploration budget to the outcome of the recent explorations", false),
+    _constrain_type("-lns_constrain_type", "LNS: the type of constrain function to be applied to search (default: strict, other values: none, loose, sa, lahc, ta, gd)", LNS_CT_STRICT),
     _max_iterations_per_intensity("-lns_max_iterations_per_intensity", "LNS: max non improving iterations before increasing relaxation intensity", 10),
     _min_intensity("-lns_min_intensity", "LNS: the minimum relaxation intensity", 1),
     _max_intensity("-lns_max_intensity", "LNS: the maximum relxation intensity", 5),
+    _min_intensity_ratio("-lns_min_intensity_ratio", "LNS: the minimum relaxation intensity, as a fraction of the relaxable variables (0: use -lns_min_intensity)", 0.0),
+    _max_intensity_ratio("-lns_max_intensity_ratio", "LNS: the maximum relaxation intensity, as a fraction of the relaxable variables (0: use -lns_max_intensity)", 0.0),
+    _intensity_adaptive("-lns_intensity_adaptive", "LNS: adapt the relaxation intensity to the outcome of the neighborhood explorations", false),
     _sa_start_temperature("-lns_sa_start_temperature", "LNS(SA): start temperature", 1.0),
     _sa_cooling_rate("-lns_sa_cooling_rate", "LNS(SA): cooling rate", 0.99),
-    _sa_neighbors_accepted("-lns_sa_neighbors_accepted", "LNS(SA): neighbors accepted per temperature", 100)    
+    _sa_neighbors_accepted("-lns_sa_neighbors_accepted", "LNS(SA): neighbors accepted per temperature", 100),
+    _sa_min_temperature("-lns_sa_min_temperature", "LNS(SA): temperature below which the start temperature is restored (0: no reheating)", 0.0),
+    _sa_target_acceptance("-lns_sa_target_acceptance", "LNS(SA): acceptance ratio the cooling adapts to (0: plain geometric cooling)", 0.0),
+    _lahc_length("-lns_lahc_length", "LNS(LAHC): length of the late acceptance history", 50),
+    _gd_rain("-lns_gd_rain", "LNS(GD): fraction by which the water level is lowered at each iteration", 0.001),
+    _workers("-lns_workers", "LNS: number of parallel LNS workers sharing the incumbent", 1),
+    _batch("-lns_batch", "LNS: number of neighbors of the current solution explored in parallel at each iteration", 1),
+    _batch_threads("-lns_batch_threads", "LNS: number of threads exploring a batch of neighbors (default: batch size)", 0),
+    _seed("-seed", "random seed (runs with the same seed and parameters are identical)", 0),
+    _bandit("-lns_bandit", "LNS: multi-armed bandit selecting the branching of each neighborhood (default: none, other values: ucb, thompson)", LNS_BANDIT_NONE),
+    _elite_size("-lns_elite_size", "LNS: number of elite solutions kept for path-relinking, crossover and restarts (0: no elite pool)", 0),
+    _elite_rate("-lns_elite_rate", "LNS: probability of generating a neighbor by path-relinking or crossover with the elite solutions", 0.2),
+    _elite_diversity("-lns_elite_diversity", "LNS: minimum distance between elite solutions (as a fraction of the relaxable variables)", 0.05),
+    _local_search("-lns_local_search", "LNS: number of iterations between two runs of the local search of the model (0: no local search)", 0),
+    _checkpoint("-lns_checkpoint", "LNS: file where the state of the search is periodically saved (default: none)", NULL),
+    _checkpoint_interval("-lns_checkpoint_interval", "LNS: seconds between two checkpoints", 60.0),
+    _resume("-lns_resume", "LNS: resume the search from the checkpoint file", false),
+    _telemetry("-lns_telemetry", "LNS: file where a record of each iteration is written (default: none)", NULL),
+    _telemetry_type("-lns_telemetry_format", "LNS: format of the telemetry file (default: csv, other values: ndjson)", LNS_TELEMETRY_CSV)
     {
+      _telemetry_type.add(LNS_TELEMETRY_CSV, "csv");
+      _telemetry_type.add(LNS_TELEMETRY_NDJSON, "ndjson");
+      _budget_type.add(LNS_BT_TIME, "time");
+      _budget_type.add(LNS_BT_FAILS, "fails");
+      _budget_type.add(LNS_BT_NODES, "nodes");
+      _bandit.add(LNS_BANDIT_NONE, "none");
+      _bandit.add(LNS_BANDIT_UCB, "ucb");
+      _bandit.add(LNS_BANDIT_THOMPSON, "thompson");
       _constrain_type.add(LNS_CT_NONE, "none");
       _constrain_type.add(LNS_CT_LOOSE, "loose");
       _constrain_type.add(LNS_CT_STRICT, "strict");
       _constrain_type.add(LNS_CT_SA, "sa");
+      _constrain_type.add(LNS_CT_LAHC, "lahc");
+      _constrain_type.add(LNS_CT_TA, "ta");
+      _constrain_type.add(LNS_CT_GD, "gd");
       
       OptionsBase::add(_time_per_variable);
+      OptionsBase::add(_budget_type);
+      OptionsBase::add(_fails_per_variable);
+      OptionsBase::add(_nodes_per_variable);
+      OptionsBase::add(_budget_adaptive);
       OptionsBase::add(_constrain_type);
       OptionsBase::add(_max_iterations_per_intensity);
       OptionsBase::add(_min_intensity);
       OptionsBase::add(_max_intensity);
+      OptionsBase::add(_min_intensity_ratio);
+      OptionsBase::add(_max_intensity_ratio);
+      OptionsBase::add(_intensity_adaptive);
       OptionsBase::add(_sa_start_temperature);
       OptionsBase::add(_sa_cooling_rate);
       OptionsBase::add(_sa_neighbors_accepted);
+      OptionsBase::add(_sa_min_temperature);
+      OptionsBase::add(_sa_target_acceptance);
+      OptionsBase::add(_lahc_length);
+      OptionsBase::add(_gd_rain);
+      OptionsBase::add(_workers);
+      OptionsBase::add(_batch);
+      OptionsBase::add(_batch_threads);
+      OptionsBase::add(_seed);
+      OptionsBase::add(_bandit);
+      OptionsBase::add(_elite_size);
+      OptionsBase::add(_elite_rate);
+      OptionsBase::add(_elite_diversity);
+      OptionsBase::add(_local_search);
+      OptionsBase::add(_checkpoint);
+      OptionsBase::add(_checkpoint_interval);
+      OptionsBase::add(_resume);
+      OptionsBase::add(_telemetry);
+      OptionsBase::add(_telemetry_type);
     }
     //    virtual void help(void);
     
     double timePerVariable(void) const { return _time_per_variable.value(); }
     void timePerVariable(double v) { _time_per_variable.value(v); }
     
+    LNSBudgetType budgetType(void) const { return static_cast<LNSBudgetType>(_budget_type.value()); }
+    void budgetType(LNSBudgetType v) { _budget_type.value(v); }
+    
+    double failsPerVariable(void) const { return _fails_per_variable.value(); }
+    void failsPerVariable(double v) { _fails_per_variable.value(v); }
+    
+    double nodesPerVariable(void) const { return _nodes_per_variable.value(); }
+    void nodesPerVariable(double v) { _nodes_per_variable.value(v); }
+    
+    bool budgetAdaptive(void) const { return _budget_adaptive.value(); }
+    void budgetAdaptive(bool v) { _budget_adaptive.value(v); }
+    
     LNSConstrainType constrainType(void) const { return static_cast<LNSConstrainType>(_constrain_type.value()); }
     void constrainType(LNSConstrainType v) { _constrain_type.value(v); }
     
@@ -137,6 +195,15 @@ namespace Gecode {
     unsigned int maxIntensity(void) const { return _max_intensity.value(); }
     void maxIntensity(unsigned int v) { _max_intensity.value(v); }
     
+    double minIntensityRatio(void) const { return _min_intensity_ratio.value(); }
+    void minIntensityRatio(double v) { _min_intensity_ratio.value(v); }
+    
+    double maxIntensityRatio(void) const { return _max_intensity_ratio.value(); }
+    void maxIntensityRatio(double v) { _max_intensity_ratio.value(v); }
+    
+    bool intensityAdaptive(void) const { return _intensity_adaptive.value(); }
+    void intensityAdaptive(bool v) { _intensity_adaptive.value(v); }
+    
     double SAstartTemperature(void) const { return _sa_start_temperature.value(); }
     void SAstartTemperature(double v) { _sa_start_temperature.value(v); }
     
@@ -145,22 +212,125 @@ namespace Gecode {
     
     unsigned int SAneighborsAccepted(void) const { return _sa_neighbors_accepted.value(); }
     void SAneighborsAccepted(unsigned int v) { _sa_neighbors_accepted.value(v); }            
+    
+    double SAminTemperature(void) const { return _sa_min_temperature.value(); }
+    void SAminTemperature(double v) { _sa_min_temperature.value(v); }
+    
+    double SAtargetAcceptance(void) const { return _sa_target_acceptance.value(); }
+    void SAtargetAcceptance(double v) { _sa_target_acceptance.value(v); }
+    
+    unsigned int LAHClength(void) const { return _lahc_length.value(); }
+    void LAHClength(unsigned int v) { _lahc_length.value(v); }
+    
+    double GDrain(void) const { return _gd_rain.value(); }
+    void GDrain(double v) { _gd_rain.value(v); }
+    
+    unsigned int workers(void) const { return _workers.value(); }
+    void workers(unsigned int v) { _workers.value(v); }
+    
+    unsigned int batch(void) const { return _batch.value(); }
+    void batch(unsigned int v) { _batch.value(v); }
+    
+    unsigned int batchThreads(void) const { return _batch_threads.value(); }
+    void batchThreads(unsigned int v) { _batch_threads.value(v); }
+    
+    unsigned int seed(void) const { return _seed.value(); }
+    void seed(unsigned int v) { _seed.value(v); }
+    
+    LNSBanditType bandit(void) const { return static_cast<LNSBanditType>(_bandit.value()); }
+    void bandit(LNSBanditType v) { _bandit.value(v); }
+    
+    unsigned int eliteSize(void) const { return _elite_size.value(); }
+    void eliteSize(unsigned int v) { _elite_size.value(v); }
+    
+    double eliteRate(void) const { return _elite_rate.value(); }
+    void eliteRate(double v) { _elite_rate.value(v); }
+    
+    double eliteDiversity(void) const { return _elite_diversity.value(); }
+    void eliteDiversity(double v) { _elite_diversity.value(v); }
+    
+    unsigned int localSearch(void) const { return _local_search.value(); }
+    void localSearch(unsigned int v) { _local_search.value(v); }
+    
+    const char* checkpoint(void) const { return _checkpoint.value(); }
+    void checkpoint(const char* v) { _checkpoint.value(v); }
+    
+    double checkpointInterval(void) const { return _checkpoint_interval.value(); }
+    void checkpointInterval(double v) { _checkpoint_interval.value(v); }
+    
+    bool resume(void) const { return _resume.value(); }
+    void resume(bool v) { _resume.value(v); }
+    
+    const char* telemetry(void) const { return _telemetry.value(); }
+    void telemetry(const char* v) { _telemetry.value(v); }
+    
+    LNSTelemetryType telemetryType(void) const { return static_cast<LNSTelemetryType>(_telemetry_type.value()); }
+    void telemetryType(LNSTelemetryType v) { _telemetry_type.value(v); }
   protected:
     LNSOptions(const LNSOptions& opt)
-    : OptionsBase(opt), _time_per_variable(opt._time_per_variable), _constrain_type(opt._constrain_type), _max_iterations_per_intensity(opt._max_iterations_per_intensity),
+    : OptionsBase(opt), _time_per_variable(opt._time_per_variable), _budget_type(opt._budget_type),
+    _fails_per_variable(opt._fails_per_variable), _nodes_per_variable(opt._nodes_per_variable), _budget_adaptive(opt._budget_adaptive), _constrain_type(opt._constrain_type), _max_iterations_per_intensity(opt._max_iterations_per_intensity),
 _min_intensity(opt._min_intensity), _max_intensity(opt._max_intensity),
-    _sa_start_temperature(opt._sa_start_temperature), _sa_cooling_rate(opt._sa_cooling_rate), _sa_neighbors_accepted(opt._sa_neighbors_accepted)
+    _min_intensity_ratio(opt._min_intensity_ratio), _max_intensity_ratio(opt._max_intensity_ratio), _intensity_adaptive(opt._intensity_adaptive),
+    _sa_start_temperature(opt._sa_start_temperature), _sa_cooling_rate(opt._sa_cooling_rate), _sa_neighbors_accepted(opt._sa_neighbors_accepted),
+    _sa_min_temperature(opt._sa_min_temperature), _sa_target_acceptance(opt._sa_target_acceptance),
+    _lahc_length(opt._lahc_length), _gd_rain(opt._gd_rain),
+    _workers(opt._workers), _batch(opt._batch), _batch_threads(opt._batch_threads),
+    _seed(opt._seed), _bandit(opt._bandit),
+    _elite_size(opt._elite_size), _elite_rate(opt._elite_rate), _elite_diversity(opt._elite_diversity),
+    _local_search(opt._local_search),
+    _checkpoint(opt._checkpoint),
+    _checkpoint_interval(opt._checkpoint_interval),
+    _resume(opt._resume),
+    _telemetry(opt._telemetry),
+    _telemetry_type(opt._telemetry_type)
     {}
     // LNS parmeters
     Driver::DoubleOption _time_per_variable;
+    Driver::StringOption _budget_type;
+    Driver::DoubleOption _fails_per_variable;
+    Driver::DoubleOption _nodes_per_variable;
+    Driver::BoolOption _budget_adaptive;
     Driver::StringOption _constrain_type;
     Driver::UnsignedIntOption _max_iterations_per_intensity;
     Driver::UnsignedIntOption _min_intensity;
     Driver::UnsignedIntOption _max_intensity;
+    Driver::DoubleOption _min_intensity_ratio;
+    Driver::DoubleOption _max_intensity_ratio;
+    Driver::BoolOption _intensity_adaptive;
     // LNS-SA specific parameters
     Driver::DoubleOption _sa_start_temperature;
     Driver::DoubleOption _sa_cooling_rate;
     Driver::UnsignedIntOption _sa_neighbors_accepted;
+    Driver::DoubleOption _sa_min_temperature;
+    Driver::DoubleOption _sa_target_acceptance;
+    // LNS-LAHC and LNS-GD specific parameters
+    Driver::UnsignedIntOption _lahc_length;
+    Driver::DoubleOption _gd_rain;
+    // Parallel LNS parameters
+    Driver::UnsignedIntOption _workers;
+    Driver::UnsignedIntOption _batch;
+    Driver::UnsignedIntOption _batch_threads;
+    // Random seed
+    Driver::UnsignedIntOption _seed;
+    // Sub-search strategy selection
+    Driver::StringOption _bandit;
+    // Elite pool parameters
+    Driver::UnsignedIntOption _elite_size;
+    Driver::DoubleOption _elite_rate;
+    Driver::DoubleOption _elite_diversity;
+    // Local search intensification
+    Driver::UnsignedIntOption _local_search;
+    // Checkpointing
+    Driver::StringValueOption _checkpoint;
+    // Seconds between two checkpoints
+    Driver::DoubleOption _checkpoint_interval;
+    // Whether to resume from the checkpoint
+    Driver::BoolOption _resume;
+    // Telemetry
+    Driver::StringValueOption _telemetry;
+    // Format of the telemetry file
+    Driver::StringOption _telemetry_type;
   };
   
   typedef LNSOptions<SizeOptions> LNSSizeOptions;
@@ -175,9 +345,9 @@ namespace Gecode { namespace Search {
   class LNSMetaStop : public Stop {
   protected:
     Stop* lns_stop;
-    TimeStop* e_stop;
+    Stop* e_stop;
   public:
-    LNSMetaStop(Stop* lns_stop0, TimeStop* e_stop0) : lns_stop(lns_stop0), e_stop(e_stop0) {}
+    LNSMetaStop(Stop* lns_stop0, Stop* e_stop0) : lns_stop(lns_stop0), e_stop(e_stop0) {}
     /// The stop method verifies a combined stopping condition
     /// (i.e., whether either the meta-engine or the engine stop criterion is satisfied)
     virtual bool stop(const Statistics& s, const Options& o) {
@@ -185,15 +355,54 @@ namespace Gecode { namespace Search {
     }
   };
   
-  /// Waiting for a more integrated (and not intrusive) solution, this class is abused
-  /// for passing specific parameters to the LNS engine
-  class LNSParameters : public LNSInstanceOptions {
+  /// This class implements the stop criterion bounding the exploration of a single neighborhood,
+  /// either on time (in milliseconds) or on the number of failures or nodes. Failures and nodes are
+  /// counted from the statistics of the engine when the criterion is reset, so that the outcome
+  /// of the exploration does not depend on the load of the machine.
+  class LNSBudgetStop : public Stop {
+  protected:
+    LNSBudgetType type;
+    TimeStop ts;
+    unsigned long int l;
+    unsigned long int base;
+    bool _exhausted;
   public:
-    LNSParameters(const LNSInstanceOptions& opt0) : LNSInstanceOptions(opt0) {}
+    LNSBudgetStop(LNSBudgetType type0) : type(type0), ts(0), l(0), base(0), _exhausted(false) {}
+    /// Set the budget for the next exploration
+    void limit(unsigned long int l0) {
+      l = l0;
+      ts.limit(l0);
+      _exhausted = false;
+    }
+    /// Start counting from the engine statistics \a s
+    void reset(const Statistics& s) {
+      base = type == LNS_BT_FAILS ? s.fail : s.node;
+      ts.reset();
+    }
+    /// Whether the last exploration has been stopped by this criterion
+    bool exhausted(void) const {
+      return _exhausted;
+    }
+    virtual bool stop(const Statistics& s, const Options& o) {
+      switch (type) {
+        case LNS_BT_FAILS:
+          _exhausted = s.fail >= base + l;
+          break;
+        case LNS_BT_NODES:
+          _exhausted = s.node >= base + l;
+          break;
+        case LNS_BT_TIME:
+        default:
+          _exhausted = ts.stop(s,o);
+          break;
+      }
+      return _exhausted;
+    }
   };
 }}
 
 #include "meta_lns.h"
+#include "meta_plns.h"
 
 namespace Gecode {
 
@@ -201,24 +410,20 @@ namespace Gecode {
   namespace Search {
     
     GECODE_SEARCH_EXPORT Engine* lns(Space* s, size_t sz,
-                                     TimeStop* e_stop,
+                                     LNSBudgetStop* e_stop,
                                      Engine* se,
                                      Engine* e,
                                      Search::Statistics& st,
-                                     const Options& o);
+                                     const Options& o,
+                                     const LNSBaseOptions& lo,
+                                     Meta::LNSIncumbent* incumbent = NULL,
+                                     unsigned int stream = 0,
+                                     unsigned int streams = 1);
   }
   
   template<template<class> class E, class T>
   forceinline
-  LNS<E,T>::LNS(T* s, const Search::Options& m_opt) : opt(m_opt) {
-    Search::Options e_opt;
-    e_opt.clone = true;
-    e_opt.threads = m_opt.threads;
-    e_opt.c_d = m_opt.c_d;
-    e_opt.a_d = m_opt.a_d;
-    Search::TimeStop* ts = new Search::TimeStop(0);
-    Search::LNSMetaStop* ms = new Search::LNSMetaStop(m_opt.stop, ts);
-    e_opt.stop = ms;
+  LNS<E,T>::LNS(T* s, const Search::Options& m_opt, const LNSBaseOptions& lo) : opt(m_opt), lns_opt(lo) {
     if (m_opt.clone) {
       if (s->status(stats) == SS_FAILED) {
         stats.fail++;
@@ -229,15 +434,63 @@ namespace Gecode {
     } else {
       root = s;
     }
-    Search::Options& s_opt(const_cast<Search::Options&>(m_opt));
+    unsigned int workers = lns_opt.workers();
+    // A failed root (NULL if it has been cloned) is left to a single worker, which finds no solution
+    if (workers <= 1 || root == NULL || root->status(stats) == SS_FAILED) {
+      e = meta(root,stats,m_opt,NULL,0,1);
+      return;
+    }
+    // Portfolio of independent workers, each one on its own (unshared) copy of the root
+    Search::Meta::PLNS* p = new Search::Meta::PLNS(workers,stats,m_opt);
+    for (unsigned int i = 0; i < workers; i++) {
+      Space* w_root = root->clone(false);
+      p->worker(static_cast<Search::Meta::LNS*>(meta(w_root,p->statistics(i),p->options(),p->incumbent(),i,workers)), w_root);
+    }
+    e = p;
+  }
+
+  template<template<class> class E, class T>
+  forceinline Search::Engine*
+  LNS<E,T>::meta(Space* r, Search::Statistics& st, const Search::Options& o,
+                 Search::Meta::LNSIncumbent* incumbent, unsigned int stream, unsigned int streams) {
+    Search::Options e_opt;
+    e_opt.clone = true;
+    e_opt.threads = o.threads;
+    e_opt.c_d = o.c_d;
+    e_opt.a_d = o.a_d;
+    Search::LNSBudgetStop* ts = new Search::LNSBudgetStop(lns_opt.budgetType());
+    Search::LNSMetaStop* ms = new Search::LNSMetaStop(o.stop, ts);
+    stops.push_back(ts);
+    stops.push_back(ms);
+    e_opt.stop = ms;
+    Search::Options& s_opt(const_cast<Search::Options&>(o));
     s_opt.clone = true;
-    engine = new E<T>(dynamic_cast<T*>(root),e_opt);
+    E<T>* engine = new E<T>(dynamic_cast<T*>(r),e_opt);
     Search::Engine* ee = engine->e; // FIXME: now this class has to be friend of BaseEngine to allow it
     engine->e = NULL;
-    start_engine = new E<T>(dynamic_cast<T*>(root),s_opt);
+    delete engine;
+    E<T>* start_engine = new E<T>(dynamic_cast<T*>(r),s_opt);
     Search::Engine* se = start_engine->e;
     start_engine->e = NULL;
-    e = Search::lns(root,sizeof(T),ts,se,ee,stats,m_opt);
+    delete start_engine;
+    Search::Meta::LNS* l = static_cast<Search::Meta::LNS*>(Search::lns(r,sizeof(T),ts,se,ee,st,o,lns_opt,incumbent,stream,streams));
+    // Further sub-engines for exploring batches of neighbors in parallel
+    unsigned int batch = lns_opt.batch();
+    for (unsigned int k = 1; k < batch; k++) {
+      Search::LNSBudgetStop* bts = new Search::LNSBudgetStop(lns_opt.budgetType());
+      e_opt.stop = new Search::LNSMetaStop(o.stop, bts);
+      stops.push_back(bts);
+      stops.push_back(e_opt.stop);
+      E<T>* b = new E<T>(dynamic_cast<T*>(r),e_opt);
+      l->batch(b->e, bts);
+      b->e = NULL;
+      delete b;
+    }
+    if (batch > 1) {
+      unsigned int threads = lns_opt.batchThreads();
+      l->pool(threads > 0 ? threads : batch);
+    }
+    return l;
   }
 
   template<template<class> class E, class T>
@@ -252,6 +505,14 @@ namespace Gecode {
     return e->statistics();
   }
 
+  template<template<class> class E, class T>
+  forceinline Search::Meta::LNSStatistics
+  LNS<E,T>::lns_statistics(void) const {
+    if (Search::Meta::PLNS* p = dynamic_cast<Search::Meta::PLNS*>(e))
+      return p->lns_statistics();
+    return static_cast<Search::Meta::LNS*>(e)->lns_statistics();
+  }
+
   template<template<class> class E, class T>
   forceinline bool
   LNS<E,T>::stopped(void) const {
@@ -262,16 +523,20 @@ namespace Gecode {
   template<template<class> class E, class T>
   forceinline 
   LNS<E,T>::~LNS(void) {
+    // The meta-engine first (it joins the workers, if any), then the stops its sub-engines refer to
+    delete e;
+    e = NULL;
+    for (unsigned int i = 0; i < stops.size(); i++)
+      delete stops[i];
     if (opt.clone)
       delete root;
-    //delete engine; delete start_engine;
   }
 
 
   template<template<class> class E, class T>
   forceinline T*
-  lns(T* s, const Search::Options& o) {    
-    LNS<E,T> l(s,o);
+  lns(T* s, const Search::Options& o, const LNSBaseOptions& lo) {
+    LNS<E,T> l(s,o,lo);
     return l.next();
   }
 
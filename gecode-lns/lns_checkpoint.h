@@ -0,0 +1,97 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+#ifndef __GECODE_SEARCH_META_LNS_CHECKPOINT_HH__
+#define __GECODE_SEARCH_META_LNS_CHECKPOINT_HH__
+
+#include <string>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Gecode { namespace Search { namespace Meta {
+
+  /**
+   * \brief State of an LNS engine, as a set of named records of numbers
+   *
+   * Checkpoints are text files with one record per line, i.e., a name
+   * followed by its values, so that they are compact, portable and can
+   * be inspected.
+   */
+  class LNSCheckpointData {
+  public:
+    /// The records
+    std::map<std::string, std::vector<double> > records;
+    /// Set record \a name to a single value
+    void set(const std::string& name, double v);
+    /// Set record \a name to a sequence of values
+    template<class T>
+    void set(const std::string& name, const std::vector<T>& v);
+    /// Return value \a i of record \a name (or \a d if there is no such value)
+    double get(const std::string& name, unsigned int i = 0, double d = 0.0) const;
+    /// Return record \a name (empty if there is no such record)
+    const std::vector<double>& values(const std::string& name) const;
+    /// Write the records to \a file
+    bool write(const std::string& file) const;
+    /// Read the records from \a file, return false if it cannot be read
+    bool read(const std::string& file);
+  };
+
+  /**
+   * \brief Background writer of checkpoints
+   *
+   * The search thread only hands over the latest state, which is written
+   * by a dedicated thread to a temporary file that is then renamed, so
+   * that a checkpoint file is always complete even if the process is
+   * killed while writing. States that are handed over while a previous
+   * one is being written replace each other, only the latest one matters.
+   */
+  class LNSCheckpoint {
+  private:
+    /// Checkpoint file
+    std::string file;
+    /// The writer thread
+    std::thread writer;
+    /// Mutex protecting the pending state
+    std::mutex m;
+    /// Signals a pending state (or termination) to the writer
+    std::condition_variable work;
+    /// State to be written
+    LNSCheckpointData pending;
+    /// Whether there is a state to be written
+    bool has_pending;
+    /// Whether the writer has to terminate
+    bool quit;
+    /// Main loop of the writer
+    void loop(void);
+  public:
+    /// Constructor for checkpoints written to \a file
+    LNSCheckpoint(const std::string& file);
+    /// Hand over state \a d to the writer
+    void write(const LNSCheckpointData& d);
+    /// Destructor (writes the pending state and waits for the writer to terminate)
+    ~LNSCheckpoint(void);
+  };
+
+  template<class T>
+  inline void
+  LNSCheckpointData::set(const std::string& name, const std::vector<T>& v) {
+    records[name] = std::vector<double>(v.begin(), v.end());
+  }
+
+}}}
+
+#endif
+
+// STATISTICS: search-other
@@ -0,0 +1,338 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+#ifndef __GECODE_SEARCH_META_LNS_OPTIONS_HH__
+#define __GECODE_SEARCH_META_LNS_OPTIONS_HH__
+
+#include <string>
+
+namespace Gecode {
+
+  enum LNSConstrainType { LNS_CT_NONE, LNS_CT_LOOSE, LNS_CT_STRICT, LNS_CT_SA, LNS_CT_LAHC, LNS_CT_TA, LNS_CT_GD };
+  enum LNSBudgetType { LNS_BT_TIME, LNS_BT_FAILS, LNS_BT_NODES };
+  enum LNSBanditType { LNS_BANDIT_NONE, LNS_BANDIT_UCB, LNS_BANDIT_THOMPSON };
+  enum LNSTelemetryType { LNS_TELEMETRY_CSV, LNS_TELEMETRY_NDJSON };
+
+  /// Interface for the parameters of the LNS meta-engine
+  class LNSBaseOptions
+  {
+  public:
+    virtual double timePerVariable(void) const = 0;
+    virtual void timePerVariable(double v) = 0;
+
+    virtual LNSBudgetType budgetType(void) const = 0;
+    virtual void budgetType(LNSBudgetType v) = 0;
+
+    virtual double failsPerVariable(void) const = 0;
+    virtual void failsPerVariable(double v) = 0;
+
+    virtual double nodesPerVariable(void) const = 0;
+    virtual void nodesPerVariable(double v) = 0;
+
+    virtual bool budgetAdaptive(void) const = 0;
+    virtual void budgetAdaptive(bool v) = 0;
+
+    virtual LNSConstrainType constrainType(void) const = 0;
+    virtual void constrainType(LNSConstrainType v) = 0;
+
+    virtual unsigned int maxIterationsPerIntensity(void) const = 0;
+    virtual void maxIterationsPerIntensity(unsigned int v) = 0;
+
+    virtual unsigned int minIntensity(void) const = 0;
+    virtual void minIntensity(unsigned int v) = 0;
+
+    virtual unsigned int maxIntensity(void) const = 0;
+    virtual void maxIntensity(unsigned int v) = 0;
+
+    virtual double minIntensityRatio(void) const = 0;
+    virtual void minIntensityRatio(double v) = 0;
+
+    virtual double maxIntensityRatio(void) const = 0;
+    virtual void maxIntensityRatio(double v) = 0;
+
+    virtual bool intensityAdaptive(void) const = 0;
+    virtual void intensityAdaptive(bool v) = 0;
+
+    virtual double SAstartTemperature(void) const = 0;
+    virtual void SAstartTemperature(double v) = 0;
+
+    virtual double SAcoolingRate(void) const = 0;
+    virtual void SAcoolingRate(double v) = 0;
+
+    virtual unsigned int SAneighborsAccepted(void) const = 0;
+    virtual void SAneighborsAccepted(unsigned int v) = 0;
+
+    virtual double SAminTemperature(void) const = 0;
+    virtual void SAminTemperature(double v) = 0;
+
+    virtual double SAtargetAcceptance(void) const = 0;
+    virtual void SAtargetAcceptance(double v) = 0;
+
+    virtual unsigned int LAHClength(void) const = 0;
+    virtual void LAHClength(unsigned int v) = 0;
+
+    virtual double GDrain(void) const = 0;
+    virtual void GDrain(double v) = 0;
+
+    virtual unsigned int workers(void) const = 0;
+    virtual void workers(unsigned int v) = 0;
+
+    virtual unsigned int batch(void) const = 0;
+    virtual void batch(unsigned int v) = 0;
+
+    virtual unsigned int batchThreads(void) const = 0;
+    virtual void batchThreads(unsigned int v) = 0;
+
+    virtual unsigned int seed(void) const = 0;
+    virtual void seed(unsigned int v) = 0;
+
+    virtual LNSBanditType bandit(void) const = 0;
+    virtual void bandit(LNSBanditType v) = 0;
+
+    virtual unsigned int eliteSize(void) const = 0;
+    virtual void eliteSize(unsigned int v) = 0;
+
+    virtual double eliteRate(void) const = 0;
+    virtual void eliteRate(double v) = 0;
+
+    virtual double eliteDiversity(void) const = 0;
+    virtual void eliteDiversity(double v) = 0;
+
+    virtual unsigned int localSearch(void) const = 0;
+    virtual void localSearch(unsigned int v) = 0;
+
+    virtual const char* checkpoint(void) const = 0;
+    virtual void checkpoint(const char* v) = 0;
+
+    virtual double checkpointInterval(void) const = 0;
+    virtual void checkpointInterval(double v) = 0;
+
+    virtual bool resume(void) const = 0;
+    virtual void resume(bool v) = 0;
+
+    virtual const char* telemetry(void) const = 0;
+    virtual void telemetry(const char* v) = 0;
+
+    virtual LNSTelemetryType telemetryType(void) const = 0;
+    virtual void telemetryType(LNSTelemetryType v) = 0;
+
+    virtual ~LNSBaseOptions(void) {}
+  };
+
+  /**
+   * \brief Plain copy of the LNS parameters
+   *
+   * Every LNS engine takes its own copy of the parameters when it is
+   * created, so that they do not change during a run and they can be
+   * read by parallel workers without synchronization.
+   */
+  class LNSParameters : public LNSBaseOptions
+  {
+  public:
+    /// Copy the parameters from \a o
+    LNSParameters(const LNSBaseOptions& o)
+    : _time_per_variable(o.timePerVariable()), _budget_type(o.budgetType()),
+      _fails_per_variable(o.failsPerVariable()), _nodes_per_variable(o.nodesPerVariable()),
+      _budget_adaptive(o.budgetAdaptive()), _constrain_type(o.constrainType()),
+      _max_iterations_per_intensity(o.maxIterationsPerIntensity()),
+      _min_intensity(o.minIntensity()), _max_intensity(o.maxIntensity()),
+      _min_intensity_ratio(o.minIntensityRatio()), _max_intensity_ratio(o.maxIntensityRatio()),
+      _intensity_adaptive(o.intensityAdaptive()),
+      _sa_start_temperature(o.SAstartTemperature()), _sa_cooling_rate(o.SAcoolingRate()),
+      _sa_neighbors_accepted(o.SAneighborsAccepted()),
+      _sa_min_temperature(o.SAminTemperature()), _sa_target_acceptance(o.SAtargetAcceptance()),
+      _lahc_length(o.LAHClength()), _gd_rain(o.GDrain()),
+      _workers(o.workers()), _batch(o.batch()), _batch_threads(o.batchThreads()),
+      _seed(o.seed()), _bandit(o.bandit()),
+      _elite_size(o.eliteSize()), _elite_rate(o.eliteRate()), _elite_diversity(o.eliteDiversity()),
+      _local_search(o.localSearch()),
+      _checkpoint(o.checkpoint() != NULL ? o.checkpoint() : ""),
+      _checkpoint_interval(o.checkpointInterval()),
+      _resume(o.resume()),
+      _telemetry(o.telemetry() != NULL ? o.telemetry() : ""),
+      _telemetry_type(o.telemetryType())
+    {}
+    LNSParameters(const LNSParameters& o)
+    : _time_per_variable(o._time_per_variable), _budget_type(o._budget_type),
+      _fails_per_variable(o._fails_per_variable), _nodes_per_variable(o._nodes_per_variable),
+      _budget_adaptive(o._budget_adaptive), _constrain_type(o._constrain_type),
+      _max_iterations_per_intensity(o._max_iterations_per_intensity),
+      _min_intensity(o._min_intensity), _max_intensity(o._max_intensity),
+      _min_intensity_ratio(o._min_intensity_ratio), _max_intensity_ratio(o._max_intensity_ratio),
+      _intensity_adaptive(o._intensity_adaptive),
+      _sa_start_temperature(o._sa_start_temperature), _sa_cooling_rate(o._sa_cooling_rate),
+      _sa_neighbors_accepted(o._sa_neighbors_accepted),
+      _sa_min_temperature(o._sa_min_temperature), _sa_target_acceptance(o._sa_target_acceptance),
+      _lahc_length(o._lahc_length), _gd_rain(o._gd_rain),
+      _workers(o._workers), _batch(o._batch), _batch_threads(o._batch_threads),
+      _seed(o._seed), _bandit(o._bandit),
+      _elite_size(o._elite_size), _elite_rate(o._elite_rate), _elite_diversity(o._elite_diversity),
+      _local_search(o._local_search),
+      _checkpoint(o._checkpoint),
+      _checkpoint_interval(o._checkpoint_interval),
+      _resume(o._resume),
+      _telemetry(o._telemetry),
+      _telemetry_type(o._telemetry_type)
+    {}
+
+    double timePerVariable(void) const { return _time_per_variable; }
+    void timePerVariable(double v) { _time_per_variable = v; }
+
+    LNSBudgetType budgetType(void) const { return _budget_type; }
+    void budgetType(LNSBudgetType v) { _budget_type = v; }
+
+    double failsPerVariable(void) const { return _fails_per_variable; }
+    void failsPerVariable(double v) { _fails_per_variable = v; }
+
+    double nodesPerVariable(void) const { return _nodes_per_variable; }
+    void nodesPerVariable(double v) { _nodes_per_variable = v; }
+
+    bool budgetAdaptive(void) const { return _budget_adaptive; }
+    void budgetAdaptive(bool v) { _budget_adaptive = v; }
+
+    LNSConstrainType constrainType(void) const { return _constrain_type; }
+    void constrainType(LNSConstrainType v) { _constrain_type = v; }
+
+    unsigned int maxIterationsPerIntensity(void) const { return _max_iterations_per_intensity; }
+    void maxIterationsPerIntensity(unsigned int v) { _max_iterations_per_intensity = v; }
+
+    unsigned int minIntensity(void) const { return _min_intensity; }
+    void minIntensity(unsigned int v) { _min_intensity = v; }
+
+    unsigned int maxIntensity(void) const { return _max_intensity; }
+    void maxIntensity(unsigned int v) { _max_intensity = v; }
+
+    double minIntensityRatio(void) const { return _min_intensity_ratio; }
+    void minIntensityRatio(double v) { _min_intensity_ratio = v; }
+
+    double maxIntensityRatio(void) const { return _max_intensity_ratio; }
+    void maxIntensityRatio(double v) { _max_intensity_ratio = v; }
+
+    bool intensityAdaptive(void) const { return _intensity_adaptive; }
+    void intensityAdaptive(bool v) { _intensity_adaptive = v; }
+
+    double SAstartTemperature(void) const { return _sa_start_temperature; }
+    void SAstartTemperature(double v) { _sa_start_temperature = v; }
+
+    double SAcoolingRate(void) const { return _sa_cooling_rate; }
+    void SAcoolingRate(double v) { _sa_cooling_rate = v; }
+
+    unsigned int SAneighborsAccepted(void) const { return _sa_neighbors_accepted; }
+    void SAneighborsAccepted(unsigned int v) { _sa_neighbors_accepted = v; }
+
+    double SAminTemperature(void) const { return _sa_min_temperature; }
+    void SAminTemperature(double v) { _sa_min_temperature = v; }
+
+    double SAtargetAcceptance(void) const { return _sa_target_acceptance; }
+    void SAtargetAcceptance(double v) { _sa_target_acceptance = v; }
+
+    unsigned int LAHClength(void) const { return _lahc_length; }
+    void LAHClength(unsigned int v) { _lahc_length = v; }
+
+    double GDrain(void) const { return _gd_rain; }
+    void GDrain(double v) { _gd_rain = v; }
+
+    unsigned int workers(void) const { return _workers; }
+    void workers(unsigned int v) { _workers = v; }
+
+    unsigned int batch(void) const { return _batch; }
+    void batch(unsigned int v) { _batch = v; }
+
+    unsigned int batchThreads(void) const { return _batch_threads; }
+    void batchThreads(unsigned int v) { _batch_threads = v; }
+
+    unsigned int seed(void) const { return _seed; }
+    void seed(unsigned int v) { _seed = v; }
+
+    LNSBanditType bandit(void) const { return _bandit; }
+    void bandit(LNSBanditType v) { _bandit = v; }
+
+    unsigned int eliteSize(void) const { return _elite_size; }
+    void eliteSize(unsigned int v) { _elite_size = v; }
+
+    double eliteRate(void) const { return _elite_rate; }
+    void eliteRate(double v) { _elite_rate = v; }
+
+    double eliteDiversity(void) const { return _elite_diversity; }
+    void eliteDiversity(double v) { _elite_diversity = v; }
+
+    unsigned int localSearch(void) const { return _local_search; }
+    void localSearch(unsigned int v) { _local_search = v; }
+
+    const char* checkpoint(void) const { return _checkpoint.empty() ? NULL : _checkpoint.c_str(); }
+    void checkpoint(const char* v) { _checkpoint = v; }
+
+    double checkpointInterval(void) const { return _checkpoint_interval; }
+    void checkpointInterval(double v) { _checkpoint_interval = v; }
+
+    bool resume(void) const { return _resume; }
+    void resume(bool v) { _resume = v; }
+
+    const char* telemetry(void) const { return _telemetry.empty() ? NULL : _telemetry.c_str(); }
+    void telemetry(const char* v) { _telemetry = v; }
+
+    LNSTelemetryType telemetryType(void) const { return _telemetry_type; }
+    void telemetryType(LNSTelemetryType v) { _telemetry_type = v; }
+  protected:
+    // LNS parmeters
+    double _time_per_variable;
+    LNSBudgetType _budget_type;
+    double _fails_per_variable;
+    double _nodes_per_variable;
+    bool _budget_adaptive;
+    LNSConstrainType _constrain_type;
+    unsigned int _max_iterations_per_intensity;
+    unsigned int _min_intensity;
+    unsigned int _max_intensity;
+    double _min_intensity_ratio;
+    double _max_intensity_ratio;
+    bool _intensity_adaptive;
+    // LNS-SA specific parameters
+    double _sa_start_temperature;
+    double _sa_cooling_rate;
+    unsigned int _sa_neighbors_accepted;
+    double _sa_min_temperature;
+    double _sa_target_acceptance;
+    // LNS-LAHC and LNS-GD specific parameters
+    unsigned int _lahc_length;
+    double _gd_rain;
+    // Parallel LNS parameters
+    unsigned int _workers;
+    unsigned int _batch;
+    unsigned int _batch_threads;
+    // Random seed
+    unsigned int _seed;
+    // Sub-search strategy selection
+    LNSBanditType _bandit;
+    // Elite pool parameters
+    unsigned int _elite_size;
+    double _elite_rate;
+    double _elite_diversity;
+    // Local search intensification
+    unsigned int _local_search;
+    // Checkpointing (a copy of the file name, the options it comes from may not outlive the engine)
+    std::string _checkpoint;
+    // Seconds between two checkpoints
+    double _checkpoint_interval;
+    // Whether to resume from the checkpoint
+    bool _resume;
+    // Telemetry
+    std::string _telemetry;
+    // Format of the telemetry file
+    LNSTelemetryType _telemetry_type;
+  };
+
+}
+
+#endif
+
+// STATISTICS: search-other
@@ -0,0 +1,72 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+#ifndef __GECODE_SEARCH_META_LNS_POOL_HH__
+#define __GECODE_SEARCH_META_LNS_POOL_HH__
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Gecode { namespace Search { namespace Meta {
+
+  /**
+   * \brief Fixed pool of threads running batches of indexed tasks
+   *
+   * The threads are created once and kept waiting between batches, so that
+   * running a batch only costs a couple of synchronizations.
+   */
+  class LNSPool {
+  private:
+    /// The threads
+    std::vector<std::thread> threads;
+    /// Mutex protecting the batch state
+    std::mutex m;
+    /// Signals new tasks (or termination) to the threads
+    std::condition_variable work;
+    /// Signals the completion of the batch
+    std::condition_variable done;
+    /// The task of the current batch
+    const std::function<void(unsigned int)>* task;
+    /// Number of tasks in the current batch
+    unsigned int tasks;
+    /// Next task to be started
+    unsigned int next_task;
+    /// Number of tasks not yet completed
+    unsigned int pending;
+    /// Whether the threads have to terminate
+    bool quit;
+    /// Main loop of each thread
+    void loop(void);
+  public:
+    /// Constructor for a pool of \a n threads
+    LNSPool(unsigned int n);
+    /// Run \a t(i) for i = 0, ..., \a n - 1 on the pool and wait for completion
+    void run(const std::function<void(unsigned int)>& t, unsigned int n);
+    /// Return the number of threads
+    unsigned int size(void) const;
+    /// Destructor (waits for the threads to terminate)
+    ~LNSPool(void);
+  };
+
+  inline unsigned int
+  LNSPool::size(void) const {
+    return threads.size();
+  }
+
+}}}
+
+#endif
+
+// STATISTICS: search-other
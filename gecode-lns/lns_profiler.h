@@ -0,0 +1,103 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+#ifndef __GECODE_SEARCH_META_LNS_PROFILER_HH__
+#define __GECODE_SEARCH_META_LNS_PROFILER_HH__
+
+#include <chrono>
+#include <ostream>
+
+namespace Gecode { namespace Search { namespace Meta {
+
+  /// Phases of an LNS iteration (and of the model) whose time is profiled
+  enum LNSPhase {
+    LNS_PHASE_INITIAL,           ///< Search of the initial solution
+    LNS_PHASE_CONSTRUCTION,      ///< Construction of the initial solution by the model
+    LNS_PHASE_CLONE,             ///< Clone of the root space into a neighbor
+    LNS_PHASE_RELAX,             ///< Relaxation (or relinking) of the neighbor
+    LNS_PHASE_RELAX_PROPAGATION, ///< Propagation done by the model to choose the variables to relax
+    LNS_PHASE_PHASE_SAVING,      ///< Saving of the values of the solution for guided value selection
+    LNS_PHASE_BRANCHING,         ///< Posting of the branching of the neighbor
+    LNS_PHASE_CONSTRAIN,         ///< Posting of the bound on the cost of the neighbor
+    LNS_PHASE_PROPAGATION,       ///< Initial propagation of the neighbor
+    LNS_PHASE_SEARCH,            ///< Sub-search of the neighbor
+    LNS_PHASE_LOCAL_SEARCH,      ///< Local search of the model
+    LNS_PHASE_SOLUTION_CLONE,    ///< Clones of the solutions (best, current and elite)
+    LNS_PHASES                   ///< Number of phases
+  };
+
+  /**
+   * \brief Time spent in and executions of each phase
+   *
+   * Every thread accumulates into its own profile, hence timers need no
+   * synchronization. The total time of a phase includes the nested phases
+   * (e.g., the propagation done by the model while relaxing), the self
+   * time excludes them, so that the self times add up.
+   */
+  class LNSProfile {
+  public:
+    /// Total time of each phase (in milliseconds)
+    double time[LNS_PHASES];
+    /// Self time of each phase (in milliseconds)
+    double self[LNS_PHASES];
+    /// Number of executions of each phase
+    unsigned long int count[LNS_PHASES];
+    /// Constructor
+    LNSProfile(void);
+    /// Accumulate the profile of another thread
+    LNSProfile& operator +=(const LNSProfile& p);
+    /// Return the name of phase \a p
+    static const char* name(unsigned int p);
+    /// Return whether profiling has been compiled in (i.e., LNS_PROFILE is defined)
+    static bool enabled(void);
+    /// Return the profile of the calling thread
+    static LNSProfile& local(void);
+    /// Return the sum of the profiles of all the threads (exact once the search has stopped)
+    static LNSProfile total(void);
+    /// Print the breakdown of the time by phase
+    void print(std::ostream& os) const;
+  };
+
+  /// Scoped timer accumulating the time of a phase into the profile of the calling thread
+  class LNSPhaseTimer {
+  private:
+    /// The phase
+    LNSPhase phase;
+    /// Start time
+    std::chrono::steady_clock::time_point start;
+    /// The enclosing timer (NULL if none)
+    LNSPhaseTimer* parent;
+    /// Time of the nested timers (in milliseconds)
+    double nested;
+    /// The innermost timer of the calling thread
+    static LNSPhaseTimer*& active(void);
+  public:
+    /// Start timing phase \a p
+    LNSPhaseTimer(LNSPhase p);
+    /// Stop timing
+    ~LNSPhaseTimer(void);
+  };
+
+}}}
+
+/// Time the rest of the enclosing scope as phase \a p (compiled out unless LNS_PROFILE is defined)
+#ifdef LNS_PROFILE
+#define LNS_PROFILE_NAME(line) lns_phase_timer_ ## line
+#define LNS_PROFILE_TIMER(p, line) ::Gecode::Search::Meta::LNSPhaseTimer LNS_PROFILE_NAME(line)(p)
+#define LNS_PROFILE_SCOPE(p) LNS_PROFILE_TIMER(p, __LINE__)
+#else
+#define LNS_PROFILE_SCOPE(p)
+#endif
+
+#endif
+
+// STATISTICS: search-other
@@ -3,6 +3,7 @@
 
 #include <gecode/kernel.hh>
 #include <gecode/driver.hh>
+#include <vector>
 
 using namespace Gecode;
 
@@ -15,12 +16,52 @@ public:
   /** Post a branching for LNS iteration step, the idea is that it should likely find a good solution  */
   virtual void neighborhood_branching() = 0;
   
+  /** Returns the number of alternative branchings for LNS iteration steps (chosen by the meta-engine) */
+  virtual unsigned int neighborhood_strategies() const { return 1; }
+  
+  /** Fix the variables of tentative (a clone of the root space) to a solution improving this one found by a model-specific local search, return the number of variables which differ from this solution (0 if none was found) */
+  virtual unsigned int local_search(Space* tentative) { return 0; }
+  
+  /** Whether the solution satisfies all the (softened) hard constraints of the problem, for statistics */
+  virtual bool feasible() const { return true; }
+  
+  /** Post alternative branching s for LNS iteration step (defaults to neighborhood_branching) */
+  virtual void neighborhood_strategy(unsigned int s) { neighborhood_branching(); }
+  
+  /** Returns the name of alternative branching s (for statistics) */
+  virtual const char* neighborhood_strategy_name(unsigned int s) const { return "default"; }
+  
   /** Method to generate a relaxed solution (i.e., a neighbor) from the current one (this) */
   virtual unsigned int relax(Space* neighbor, unsigned int free) = 0;
   
+  /** Returns the number of components of the objective function (for telemetry) */
+  virtual unsigned int cost_components() const { return 0; }
+  
+  /** Returns the name of component i of the objective function */
+  virtual const char* cost_component_name(unsigned int i) const { return ""; }
+  
+  /** Returns the value of component i of the objective function of the current (solved) space */
+  virtual double cost_component(unsigned int i) const { return 0.0; }
+  
+  /** Append the values of the variables of the current (solved) space to v, for checkpointing (defaults to none, i.e., no checkpoints) */
+  virtual void save(std::vector<int>& v) const {}
+  
+  /** Fix the variables of this space (a clone of the root space) to the values appended by save, return false if they cannot be restored */
+  virtual bool restore(const std::vector<int>& v) { return false; }
+  
   /** Returns the number of relaxable variables */
   virtual unsigned int relaxable_vars() const = 0;
   
+  /** Method to generate a neighbor that keeps the variables on which the current space (this) agrees with guide, 
+      and relaxes the others plus free more, e.g., for path-relinking and crossover (defaults to plain relax) */
+  virtual unsigned int relink(Space* neighbor, const Space& guide, unsigned int free) { return relax(neighbor, free); }
+  
+  /** Returns the number of relaxable variables on which the current space differs from s (defaults to 0, i.e., no diversity) */
+  virtual unsigned int distance(const Space& s) const { return 0; }
+  
+  /* Returns the value of the objective function of the current (solved) space */
+  virtual double objective() const = 0;
+  
   /* Returns whether the current space is improving w.r.t. s */
   virtual bool improving(const Space& s, bool strict = true) = 0;
   
@@ -31,6 +72,11 @@ public:
 class LNSMinimizeScript : public LNSAbstractSpace, public MinimizeScript
 {
 public:
+  virtual double objective() const
+  {
+    return this->cost().val();
+  }
+  
   virtual bool improving(const Space& s, bool strict = true)
   {
     const LNSMinimizeScript& _s = dynamic_cast<const LNSMinimizeScript&>(s);
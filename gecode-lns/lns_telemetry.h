@@ -0,0 +1,126 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+#ifndef __GECODE_SEARCH_META_LNS_TELEMETRY_HH__
+#define __GECODE_SEARCH_META_LNS_TELEMETRY_HH__
+
+#include "lns_options.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Gecode { namespace Search { namespace Meta {
+
+  /// How a neighbor has been generated
+  enum LNSOperator { LNS_OP_RELAX, LNS_OP_RELINK, LNS_OP_CROSSOVER, LNS_OP_LOCAL_SEARCH };
+  
+  /// What happened to the solution found in a neighbor
+  enum LNSOutcome { LNS_OUTCOME_NONE, LNS_OUTCOME_IMPROVING, LNS_OUTCOME_ACCEPTED, LNS_OUTCOME_REJECTED };
+  
+  /// Record of an LNS iteration
+  class LNSIterationRecord {
+  public:
+    /// Maximum number of components of the objective function which are recorded
+    static const unsigned int max_components = 8;
+    /// Number of the iteration (i.e., of neighbors explored so far)
+    unsigned long int iteration;
+    /// Time of the end of the iteration (in milliseconds since the engine was created)
+    double time;
+    /// How the neighbor has been generated
+    LNSOperator op;
+    /// Sub-search strategy
+    unsigned int strategy;
+    /// Intensity
+    unsigned int intensity;
+    /// Number of relaxed variables
+    unsigned int relaxed;
+    /// Temperature (for SA and threshold accepting)
+    double temperature;
+    /// Nodes and failures of the sub-search
+    unsigned long int nodes, fails;
+    /// Wall-clock time of the sub-search (in milliseconds)
+    double search_time;
+    /// What happened to the solution found (if any)
+    LNSOutcome outcome;
+    /// Cost of the current solution at the end of the iteration
+    double cost;
+    /// Components of the cost of the solution found (or of the current one if none)
+    double components[max_components];
+  };
+  
+  /**
+   * \brief Stream of records of the LNS iterations
+   *
+   * Records are pushed by the search thread into a bounded single-producer
+   * single-consumer ring buffer, which only costs a copy and an atomic
+   * store, and a background thread drains them to a CSV or NDJSON file.
+   * Records are dropped rather than blocking the search if the buffer is
+   * full, i.e., if the writer cannot keep up.
+   */
+  class LNSTelemetry {
+  private:
+    /// Capacity of the ring buffer (a power of two)
+    static const unsigned long int capacity = 1 << 14;
+    /// The ring buffer
+    std::vector<LNSIterationRecord> ring;
+    /// Number of records pushed (only written by the producer)
+    std::atomic<unsigned long int> head;
+    /// Number of records drained (only written by the writer)
+    std::atomic<unsigned long int> tail;
+    /// Number of records dropped because the buffer was full (or because they were too long)
+    std::atomic<unsigned long int> dropped;
+    /// Output file
+    std::string file;
+    /// Output format
+    LNSTelemetryType type;
+    /// Index of the worker
+    unsigned int stream;
+    /// Names of the components of the objective function
+    std::vector<std::string> components;
+    /// The writer thread
+    std::thread writer;
+    /// Mutex and condition for waking up the writer on termination
+    std::mutex m;
+    std::condition_variable wake;
+    /// Whether the writer has to terminate
+    bool quit;
+    /// Main loop of the writer
+    void loop(void);
+  public:
+    /// Constructor for records of worker \a stream written to \a file, with the given names of the cost components
+    LNSTelemetry(const std::string& file, LNSTelemetryType type, unsigned int stream, const std::vector<std::string>& components);
+    /// Push record \a r (dropped if the buffer is full)
+    void push(const LNSIterationRecord& r);
+    /// Destructor (drains the remaining records and waits for the writer to terminate)
+    ~LNSTelemetry(void);
+  };
+  
+  inline void
+  LNSTelemetry::push(const LNSIterationRecord& r) {
+    unsigned long int h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= capacity)
+    {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring[h & (capacity - 1)] = r;
+    head.store(h + 1, std::memory_order_release);
+  }
+
+}}}
+
+#endif
+
+// STATISTICS: search-other
@@ -16,44 +16,325 @@
 #define __GECODE_SEARCH_META_LNS_HH__
 
 #include <gecode/search.hh>
-#include "lns.h"
+#include "lns_options.h"
+#include "lns_pool.h"
+#include "lns_checkpoint.h"
+#include "lns_telemetry.h"
+#include "lns_profiler.h"
+#include "../random.hh"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+
+namespace Gecode { namespace Search {
+  class LNSBudgetStop;
+}}
 
 namespace Gecode { namespace Search { namespace Meta {
 
+  /**
+   * \brief Incumbent solution shared among parallel LNS workers
+   *
+   * Publishing and adopting a solution clones it under a lock, whereas
+   * checking for news only reads an atomic version counter, so that the
+   * workers can poll it at every iteration with negligible contention.
+   */
+  class LNSIncumbent {
+  private:
+    /// The best solution published so far (owned)
+    Space* best;
+    /// Number of published improvements
+    std::atomic<unsigned long int> _version;
+    /// Mutex protecting \a best
+    mutable std::mutex m;
+  public:
+    /// Constructor
+    LNSIncumbent(void);
+    /// Publish \a s, return whether it improved the incumbent
+    bool offer(Space& s);
+    /// Return a copy of the incumbent if it is improving w.r.t. \a s (NULL otherwise), update \a seen
+    Space* adopt(Space& s, unsigned long int& seen);
+    /// Return a copy of the incumbent (NULL if none), update \a seen
+    Space* get(unsigned long int& seen);
+    /// Return the number of published improvements
+    unsigned long int version(void) const;
+    /// Destructor
+    ~LNSIncumbent(void);
+  };
+
+  forceinline unsigned long int
+  LNSIncumbent::version(void) const {
+    return _version.load(std::memory_order_acquire);
+  }
+
+  /// Statistics of a sub-search strategy (i.e., an arm of the bandit)
+  class LNSArmStatistics {
+  public:
+    /// Name of the strategy
+    const char* name;
+    /// Number of neighbors explored with the strategy
+    unsigned long int pulls;
+    /// Number of successes (for Thompson sampling)
+    unsigned long int successes;
+    /// Total improvement of the objective function
+    double improvement;
+    /// Total time spent in the sub-searches (in milliseconds)
+    double time;
+    /// Sum of the rewards (improvement per millisecond)
+    double reward;
+    /// Constructor
+    LNSArmStatistics(const char* name0 = "") : name(name0), pulls(0), successes(0), improvement(0.0), time(0.0), reward(0.0) {}
+    /// Accumulate the statistics of the same arm of another (parallel) engine
+    LNSArmStatistics& operator +=(const LNSArmStatistics& a) {
+      pulls += a.pulls;
+      successes += a.successes;
+      improvement += a.improvement;
+      time += a.time;
+      reward += a.reward;
+      return *this;
+    }
+    /// Average reward
+    double mean(void) const {
+      return pulls > 0 ? reward / pulls : 0.0;
+    }
+  };
+
+  /// Effort spent exploring a neighbor
+  class LNSExploration {
+  public:
+    /// Wall-clock time (in milliseconds)
+    double time;
+    /// Nodes and failures of the sub-search
+    unsigned long int nodes, fails;
+    /// Constructor
+    LNSExploration(void) : time(0.0), nodes(0), fails(0) {}
+  };
+
+  /// Statistics specific to large neighborhood search
+  class LNSStatistics {
+  public:
+    /// Number of neighbors explored
+    unsigned long int neighbors;
+    /// Number of improving solutions found
+    unsigned long int improvements;
+    /// Number of spaces cloned by the meta-engine
+    unsigned long int clones;
+    /// Wall-clock time spent searching (in milliseconds)
+    double time;
+    /// Size of the batch of neighbors explored at each iteration
+    unsigned int batch;
+    /// Number of threads exploring the neighbors
+    unsigned int threads;
+    /// Number of runs of the local search of the model
+    unsigned long int local_searches;
+    /// Time to the first solution (in milliseconds since the engine was created, negative if none)
+    double first;
+    /// Time to the first feasible solution (in milliseconds since the engine was created, negative if none)
+    double first_feasible;
+    /// Statistics of the sub-search strategies (empty if not selected by a bandit)
+    std::vector<LNSArmStatistics> arms;
+    /// Constructor
+    LNSStatistics(void) : neighbors(0), improvements(0), clones(0), time(0.0), batch(1), threads(1), local_searches(0), first(-1.0), first_feasible(-1.0) {}
+    /// Accumulate the statistics of another (parallel) engine
+    LNSStatistics& operator +=(const LNSStatistics& s) {
+      neighbors += s.neighbors;
+      improvements += s.improvements;
+      clones += s.clones;
+      if (s.time > time)
+        time = s.time;
+      threads += s.threads;
+      local_searches += s.local_searches;
+      if (s.first >= 0.0 && (first < 0.0 || s.first < first))
+        first = s.first;
+      if (s.first_feasible >= 0.0 && (first_feasible < 0.0 || s.first_feasible < first_feasible))
+        first_feasible = s.first_feasible;
+      if (arms.empty())
+        arms = s.arms;
+      else
+        for (unsigned int i = 0; i < arms.size() && i < s.arms.size(); i++)
+          arms[i] += s.arms[i];
+      return *this;
+    }
+    /// Neighbors explored per second
+    double throughput(void) const {
+      return time > 0.0 ? 1000.0 * neighbors / time : 0.0;
+    }
+  };
+
+  /**
+   * \brief Bounded pool of good and diverse solutions
+   *
+   * A solution enters the pool if its distance from all the elite
+   * solutions is at least a given fraction of the relaxable variables,
+   * taking the place of the worst elite solution if the pool is full and
+   * it is better. A solution closer than that to an elite solution only
+   * takes the place of the latter, if better.
+   */
+  class LNSElitePool {
+  private:
+    /// The elite solutions (owned)
+    std::vector<Space*> elite;
+    /// Maximum number of elite solutions
+    unsigned int capacity;
+    /// Minimum distance among elite solutions, as a fraction of the relaxable variables
+    double diversity;
+    /// Minimum distance among elite solutions (computed on the first insertion)
+    unsigned int min_distance;
+  public:
+    /// Constructor
+    LNSElitePool(unsigned int capacity0, double diversity0);
+    /// Try to insert (a copy of) \a s, return whether it has been inserted
+    bool insert(Space& s, bool shared);
+    /// Return the number of elite solutions
+    unsigned int size(void) const;
+    /// Return elite solution \a i
+    Space* operator [](unsigned int i) const;
+    /// Destructor
+    ~LNSElitePool(void);
+  };
+
+  forceinline unsigned int
+  LNSElitePool::size(void) const {
+    return elite.size();
+  }
+
+  forceinline Space*
+  LNSElitePool::operator [](unsigned int i) const {
+    return elite[i];
+  }
+
   /// Engine for restart-based search
   class LNS : public Engine {
   private:
     /// The actual engine(s)
     Engine* se;
     Engine* e;
+    /// Additional sub-engines (and their stop objects) exploring batches of neighbors in parallel
+    std::vector<Engine*> b_engines;
+    std::vector<LNSBudgetStop*> b_stops;
+    /// The thread pool running batches of neighbors (NULL if neighbors are explored one at a time)
+    LNSPool* b_pool;
     /// The root space to create new partial solutions from scratch
     Space* root;
-    /// The best solution that far
+    /// The best solution that far (it may be the same space as current)
     Space* best;
-    /// The current solution
+    /// The current solution (it may be the same space as best)
     Space* current;
     /// The stop control object for the sub-engine
-    TimeStop* e_stop;
+    LNSBudgetStop* e_stop;
     /// The stop control object for the overall LNS
     Stop* m_stop;
     /// The statistics
     Search::Statistics& stats;
     /// The options
-    const Options& opt;
+    const Options opt;
+    /// The LNS parameters (a private copy, they do not change during the run)
+    const LNSParameters lns_opt;
     /// The number of times stop has reached
     unsigned long int restart;
     /// The number of idle iterations performed (for detecting stagnation)
     unsigned long int idle_iterations;
     /// The current intensity for LNS
     unsigned int intensity;
+    /// The intensity before rounding (for the adaptive schedule)
+    double intensity_level;
+    /// The intensity bounds for this instance and the increment on stagnation
+    unsigned int min_intensity, max_intensity, intensity_step;
     /// Whether the slave can be shared with the master
     bool shared;
-    /// Random numbers generator
-    Rnd r;
+    /// State of the random numbers generator (installed in the running thread by next)
+    Random::State rng;
+    /// The pool of elite solutions
+    LNSElitePool elite;
+    /// Scaling factor of the exploration budget (adapted to the outcome of the explorations)
+    double budget_scale;
     /// Current temperature for SA
     double temperature;
     /// Neighbors accepted at current temperature
     unsigned long int neighbors_accepted;
+    /// Neighbors explored at current temperature
+    unsigned long int neighbors_explored;
+    /// History of the costs of the current solution for late acceptance
+    std::vector<double> history;
+    /// Number of iterations since the start of late acceptance
+    unsigned long int history_iterations;
+    /// Water level for great deluge
+    double level;
+    /// The incumbent shared with other workers (NULL if running alone)
+    LNSIncumbent* incumbent;
+    /// Version of the shared incumbent last seen by this worker
+    unsigned long int incumbent_version;
+    /// Index of this worker (used to diversify random streams)
+    unsigned int stream;
+    /// Number of workers
+    unsigned int streams;
+    /// LNS specific statistics
+    LNSStatistics lns_stats;
+    /// Creation time of the engine (origin of the times to the first solutions)
+    std::chrono::steady_clock::time_point created;
+    /// The writer of the checkpoints (NULL if not checkpointing)
+    LNSCheckpoint* checkpointer;
+    /// The checkpoint file of this worker
+    std::string checkpoint_file;
+    /// Time of the last checkpoint
+    std::chrono::steady_clock::time_point checkpointed;
+    /// Whether the search has still to be resumed from the checkpoint file
+    bool resuming;
+    /// The stream of records of the iterations (NULL if no telemetry)
+    LNSTelemetry* telemetry;
+    /// Clone \a s (counting the clone and profiling it as phase \a p)
+    Space* clone(Space& s, LNSPhase p = LNS_PHASE_SOLUTION_CLONE);
+    /// Make \a s0 (possibly NULL) the space in slot \a s (either best or current), deleting the old one unless still in use
+    void replace(Space*& s, Space* s0);
+    /// Adopt the shared incumbent if it improves over the best solution of this worker
+    void adopt(void);
+    /// Create a neighbor of the current solution, return the number of relaxed variables in \a relaxed, the sub-search strategy in \a arm and how it has been generated in \a op
+    Space* neighbor(unsigned int& relaxed, unsigned int& arm, LNSOperator& op);
+    /// Explore \a neighbor with sub-engine \a s_e stopped by \a s_stop, return the last solution found (if any) and the effort spent in \a x
+    Space* explore(Space* neighbor, unsigned int relaxed, Engine* s_e, LNSBudgetStop* s_stop, Search::Statistics& st, LNSExploration& x);
+    /// Set up the statistics of the sub-search strategies of the model (if they are selected by a bandit)
+    void strategies(void);
+    /// Record the time of solution \a n, if it is the first (feasible) one
+    void found(const Space& n);
+    /// Select the sub-search strategy for the next neighbor
+    unsigned int select(void);
+    /// Reward strategy \a arm for finding \a n (possibly NULL) in \a time milliseconds
+    void reward(unsigned int arm, Space* n, double time);
+    /// Return the budget for exploring a neighbor with \a relaxed relaxed variables
+    unsigned long int budget(unsigned int relaxed) const;
+    /// Compute the intensity bounds for the instance in the root space
+    void limits(void);
+    /// Reset the intensity to its minimum
+    void reset_intensity(void);
+    /// Post on neighbor \a n the bound on the cost for being accepted as the next current solution
+    void accept(Space& n);
+    /// Start the acceptance criterion from the solution \a s
+    void start(Space& s);
+    /// Return the bound on the cost of the next neighbors for late acceptance, threshold accepting and great deluge
+    double bound(void) const;
+    /// Update the state of the acceptance criterion at the end of an iteration
+    void step(void);
+    /// Update the temperature for SA (and the threshold for threshold accepting)
+    void cool(void);
+    /// Adapt the budget and the intensity to the outcome of an exploration stopped by \a s_stop (\a found tells whether it found a solution)
+    void adapt(const LNSBudgetStop& s_stop, bool found);
+    /// Run the local search of the model from the current (feasible) solution, return the solution found (if any), the number of variables changed in \a moved and the effort spent in \a x
+    Space* intensify(unsigned int& moved, LNSExploration& x);
+    /// Explore a batch of neighbors in parallel, return the best solution found (if any), how its neighbor has been generated in \a relaxed, \a arm and \a op, and the total effort spent in \a x
+    Space* explore_batch(unsigned int& relaxed, unsigned int& arm, LNSOperator& op, LNSExploration& x);
+    /// Set up the telemetry according to the parameters
+    void monitor(void);
+    /// Record an iteration which generated a neighbor by \a op with \a relaxed relaxed variables and strategy \a arm, explored it with effort \a x, and found \a n (possibly NULL) with \a outcome
+    void trace(LNSOperator op, unsigned int arm, unsigned int relaxed, const LNSExploration& x, const Space* n, LNSOutcome outcome);
+    /// Set up checkpointing (and resuming) according to the parameters
+    void checkpoints(void);
+    /// Hand over the state of the search to the checkpoint writer
+    void checkpoint(void);
+    /// Rebuild a solution from the values of its variables (NULL if it cannot be rebuilt)
+    Space* rebuild(const std::vector<double>& values);
+    /// Restore the state of the search from the checkpoint file, return the best solution (NULL if it cannot be restored)
+    Space* resume(void);
     
     /// Empty no-goods (copied from RBS)
     GECODE_SEARCH_EXPORT
@@ -61,12 +342,19 @@ namespace Gecode { namespace Search { namespace Meta {
     
   public:
     /// Constructor
-    LNS(Space*, size_t, TimeStop* e_stop0,
-        Engine* se0, Engine* e0, Search::Statistics& stats0, const Options& opt0);
+    LNS(Space*, size_t, LNSBudgetStop* e_stop0,
+        Engine* se0, Engine* e0, Search::Statistics& stats0, const Options& opt0,
+        const LNSBaseOptions& lns_opt0, LNSIncumbent* incumbent0 = NULL, unsigned int stream0 = 0, unsigned int streams0 = 1);
     /// Return next solution (NULL, if none exists or search has been stopped)
     virtual Space* next(void);
     /// Return statistics
     virtual Search::Statistics statistics(void) const;
+    /// Return LNS specific statistics
+    LNSStatistics lns_statistics(void) const;
+    /// Add a sub-engine (with its stop object) for exploring batches of neighbors
+    void batch(Engine* e0, LNSBudgetStop* e_stop0);
+    /// Explore batches of neighbors on a pool of \a threads threads
+    void pool(unsigned int threads);
     /// Check whether engine has been stopped
     virtual bool stopped(void) const;
     /// Reset engine to restart at space \a s
@@ -75,16 +363,45 @@ namespace Gecode { namespace Search { namespace Meta {
     virtual NoGoods& nogoods(void);
     /// Destructor
     virtual ~LNS(void);
-    /// FIXME: waiting for a definitive way to pass specific options to the (meta-)engines, currently they will be embedded in
-    /// a static member of the LNS class
-    static LNSBaseOptions* lns_options;
   };
 
   forceinline
-  LNS::LNS(Space* s, size_t, TimeStop* e_stop0, 
-           Engine* se0, Engine* e0, Search::Statistics& stats0, const Options& opt0)
-    : se(se0), e(e0), root(s), best(0), current(0), e_stop(e_stop0), m_stop(opt0.stop), stats(stats0), opt(opt0), restart(0), idle_iterations(0),
-  shared(opt.threads == 1), temperature(1.0) {}
+  LNS::LNS(Space* s, size_t, LNSBudgetStop* e_stop0, 
+           Engine* se0, Engine* e0, Search::Statistics& stats0, const Options& opt0,
+           const LNSBaseOptions& lns_opt0, LNSIncumbent* incumbent0, unsigned int stream0, unsigned int streams0)
+    : se(se0), e(e0), b_pool(NULL), root(s), best(0), current(0), e_stop(e_stop0), m_stop(opt0.stop), stats(stats0), opt(opt0), lns_opt(lns_opt0), restart(0), idle_iterations(0),
+  intensity(0), intensity_level(0.0), min_intensity(0), max_intensity(0), intensity_step(1),
+  shared(opt.threads == 1), rng(Random::Stream(lns_opt0.seed(), stream0)), elite(lns_opt0.eliteSize(), lns_opt0.eliteDiversity()), budget_scale(1.0), temperature(1.0), neighbors_accepted(0), neighbors_explored(0), history_iterations(0), level(0.0), incumbent(incumbent0), incumbent_version(0), stream(stream0), streams(streams0), created(std::chrono::steady_clock::now()), checkpointer(NULL), checkpointed(created), resuming(false), telemetry(NULL) {
+    if (root != NULL)
+    {
+      limits();
+      strategies();
+      checkpoints();
+      monitor();
+    }
+  }
+
+  forceinline LNSStatistics
+  LNS::lns_statistics(void) const {
+    return lns_stats;
+  }
+
+  forceinline Space*
+  LNS::clone(Space& s, LNSPhase p) {
+    lns_stats.clones++;
+    LNS_PROFILE_SCOPE(p);
+    return s.clone(shared);
+  }
+
+  forceinline void
+  LNS::replace(Space*& s, Space* s0) {
+    if (s == s0)
+      return;
+    // best and current may share the same space
+    if (s != best || s != current)
+      delete s;
+    s = s0;
+  }
 
 }}}
 
@@ -0,0 +1,124 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     Luca Di Gaspero <luca.digaspero@uniud.it>
+ *     Tommaso Urli <tommaso.urli@uniud.it>
+ *
+ *  Copyright:
+ *     Luca Di Gaspero, Tommaso Urli, 2013
+ *
+ *
+ */
+
+
+
+#ifndef __GECODE_SEARCH_META_PLNS_HH__
+#define __GECODE_SEARCH_META_PLNS_HH__
+
+#include <gecode/search.hh>
+#include "meta_lns.h"
+#include <vector>
+#include <thread>
+#include <condition_variable>
+
+namespace Gecode { namespace Search { namespace Meta {
+
+  /// Stop object for parallel LNS workers: stops either on cancellation or on the overall stop
+  class PLNSStop : public Stop {
+  protected:
+    Stop* m_stop;
+    const std::atomic<bool>& cancelled;
+  public:
+    PLNSStop(Stop* m_stop0, const std::atomic<bool>& cancelled0) : m_stop(m_stop0), cancelled(cancelled0) {}
+    virtual bool stop(const Statistics& s, const Options& o) {
+      return cancelled.load(std::memory_order_relaxed) || (m_stop != NULL && m_stop->stop(s,o));
+    }
+  };
+
+  /**
+   * \brief Engine for parallel (portfolio) large neighborhood search
+   *
+   * Runs a number of independent LNS workers, each one on its own thread
+   * and with its own spaces and sub-engines. Improving solutions are
+   * published through a shared incumbent, which the workers adopt when it
+   * is better than their own best solution. Each call to next returns the
+   * next improvement of the shared incumbent.
+   */
+  class PLNS : public Engine {
+  private:
+    /// The workers
+    std::vector<LNS*> workers;
+    /// The root spaces of the workers
+    std::vector<Space*> roots;
+    /// The statistics of the workers
+    std::vector<Search::Statistics> w_stats;
+    /// The threads running the workers
+    mutable std::vector<std::thread> threads;
+    /// The shared incumbent
+    LNSIncumbent _incumbent;
+    /// Whether the workers have been asked to stop
+    mutable std::atomic<bool> cancelled;
+    /// The stop control object for the workers
+    PLNSStop w_stop;
+    /// The options for the workers
+    Options w_opt;
+    /// Mutex and condition for waiting on the workers
+    std::mutex m;
+    std::condition_variable cv;
+    /// Number of workers still running
+    unsigned int running;
+    /// Version of the incumbent last returned by next
+    unsigned long int reported;
+    /// The statistics
+    Search::Statistics& stats;
+    /// The options
+    const Options& opt;
+    /// Run worker \a i until it stops
+    void run(unsigned int i);
+    /// Stop the workers and wait for them to terminate (so that their state can be read)
+    void halt(void) const;
+  public:
+    /// Constructor for \a n workers
+    PLNS(unsigned int n, Search::Statistics& stats0, const Options& opt0);
+    /// Add a worker running on root space \a r (the engine takes ownership of both)
+    void worker(LNS* w, Space* r);
+    /// Return the incumbent to be shared among the workers
+    LNSIncumbent* incumbent(void);
+    /// Return the statistics for worker \a i
+    Search::Statistics& statistics(unsigned int i);
+    /// Return the options for the workers
+    const Options& options(void) const;
+    /// Return next solution (NULL, if none exists or search has been stopped)
+    virtual Space* next(void);
+    /// Return statistics (the workers are stopped first)
+    virtual Search::Statistics statistics(void) const;
+    /// Return LNS specific statistics (accumulated over the workers, which are stopped first)
+    LNSStatistics lns_statistics(void) const;
+    /// Check whether engine has been stopped
+    virtual bool stopped(void) const;
+    /// Return no-goods
+    virtual NoGoods& nogoods(void);
+    /// Destructor (stops and joins the workers, then deletes them and their roots)
+    virtual ~PLNS(void);
+  };
+
+  forceinline LNSIncumbent*
+  PLNS::incumbent(void) {
+    return &_incumbent;
+  }
+
+  forceinline Search::Statistics&
+  PLNS::statistics(unsigned int i) {
+    return w_stats[i];
+  }
+
+  forceinline const Options&
+  PLNS::options(void) const {
+    return w_opt;
+  }
+
+}}}
+
+#endif
+
+// STATISTICS: search-other
@@ -0,0 +1,290 @@
+#include "local_search.hh"
+#include "costs.hh"
+#include "random.hh"
+#include <algorithm>
+#include <climits>
+
+KempeSearch::KempeSearch(const Faculty& in) : in(in), _weight(0)
+{
+    for (unsigned int c = 0; c < in.Courses(); c++)
+    {
+        first_lecture.push_back(course.size());
+        for (unsigned int i = 0; i < in.CourseVector(c).Lectures(); i++)
+            course.push_back(c);
+    }
+}
+
+void KempeSearch::fix(const vector<bool>& fixed)
+{
+    _fixed = fixed;
+}
+
+void KempeSearch::perturbation(const vector<int>& reference, int weight)
+{
+    _reference = reference;
+    _weight = weight;
+}
+
+bool KempeSearch::in_place(const vector<unsigned int>& period, const vector<unsigned int>& room) const
+{
+    for (unsigned int l = 0; l < _fixed.size(); l++)
+        if (_fixed[l] && (period[l] != initial_period[l] || room[l] != initial_room[l]))
+            return false;
+    return true;
+}
+
+int KempeSearch::cost(const vector<unsigned int>& period, const vector<unsigned int>& room) const
+{
+    int capacity = 0, stability = 0, working_days = 0, compactness = 0;
+
+    for (unsigned int l = 0; l < course.size(); l++)
+        capacity += max(0, (int) in.CourseVector(course[l]).Students() - (int) in.RoomVector(room[l] + 1).Capacity());
+
+    for (unsigned int c = 0; c < in.Courses(); c++)
+    {
+        vector<bool> rooms(in.Rooms(), false), days(in.Days(), false);
+        int used_rooms = 0, used_days = 0;
+        for (unsigned int l = first_lecture[c]; l < first_lecture[c] + in.CourseVector(c).Lectures(); l++)
+        {
+            if (!rooms[room[l]])
+                used_rooms++;
+            if (!days[period[l] / in.PeriodsPerDay()])
+                used_days++;
+            rooms[room[l]] = true;
+            days[period[l] / in.PeriodsPerDay()] = true;
+        }
+        if (used_rooms > 0)
+            stability += used_rooms - 1;
+        working_days += max(0, (int) in.CourseVector(c).MinWorkingDays() - used_days);
+    }
+
+    // Isolated lectures, i.e., with no lecture of the same curriculum in the adjacent periods of the same day
+    for (unsigned int q = 0; q < in.Curricula(); q++)
+    {
+        vector<bool> busy(in.Periods(), false);
+        const vector<unsigned int>& members = in.CurriculaVector(q).members;
+        for (unsigned int i = 0; i < members.size(); i++)
+            for (unsigned int l = first_lecture[members[i]]; l < first_lecture[members[i]] + in.CourseVector(members[i]).Lectures(); l++)
+                busy[period[l]] = true;
+        for (unsigned int i = 0; i < members.size(); i++)
+            for (unsigned int l = first_lecture[members[i]]; l < first_lecture[members[i]] + in.CourseVector(members[i]).Lectures(); l++)
+            {
+                unsigned int p = period[l], timeslot = p % in.PeriodsPerDay();
+                bool before = timeslot > 0 && busy[p - 1], after = timeslot < in.PeriodsPerDay() - 1 && busy[p + 1];
+                if (!before && !after)
+                    compactness++;
+            }
+    }
+
+    // Lectures moved away from the perturbed timetable
+    int moved = 0;
+    for (unsigned int l = 0; l < _reference.size(); l++)
+        if (_reference[l] >= 0 && (int) (period[l] * in.Rooms() + room[l]) != _reference[l])
+            moved++;
+
+    return capacity * ROOM_CAPACITY_COST + stability * ROOM_STABILITY_COST +
+           working_days * MINIMUM_WORKING_DAYS_COST + compactness * CURRICULUM_COMPACTNESS_COST + moved * _weight;
+}
+
+bool KempeSearch::kempe_chain(unsigned int l, unsigned int q, const vector<unsigned int>& period, vector<unsigned int>& chain) const
+{
+    unsigned int p = period[l];
+    vector<unsigned int> lectures;
+    for (unsigned int k = 0; k < course.size(); k++)
+        if (period[k] == p || period[k] == q)
+            lectures.push_back(k);
+
+    // Breadth-first visit of the conflict graph restricted to the two periods
+    vector<bool> visited(lectures.size(), false);
+    chain.assign(1, l);
+    for (unsigned int i = 0; i < lectures.size(); i++)
+        if (lectures[i] == l)
+            visited[i] = true;
+    int moved = 0; // lectures entering q, minus lectures leaving it
+    for (unsigned int head = 0; head < chain.size(); head++)
+    {
+        unsigned int k = chain[head], target = period[k] == p ? q : p;
+        if (!in.Available(course[k], target) || (!_fixed.empty() && _fixed[k]))
+            return false;
+        moved += target == q ? 1 : -1;
+        for (unsigned int i = 0; i < lectures.size(); i++)
+            if (!visited[i] && period[lectures[i]] == target && conflict(k, lectures[i]))
+            {
+                visited[i] = true;
+                chain.push_back(lectures[i]);
+            }
+    }
+
+    // Rooms are enough in both periods
+    unsigned int in_p = 0, in_q = 0;
+    for (unsigned int i = 0; i < lectures.size(); i++)
+        (period[lectures[i]] == p ? in_p : in_q)++;
+    return in_q + moved <= in.Rooms() && in_p - moved <= in.Rooms();
+}
+
+void KempeSearch::assign_rooms(unsigned int p, const vector<unsigned int>& period, vector<unsigned int>& room) const
+{
+    // The rooms of the fixed lectures are not available to the other ones
+    vector<unsigned int> lectures, rooms;
+    vector<bool> taken(in.Rooms(), false);
+    for (unsigned int l = 0; l < course.size(); l++)
+        if (period[l] == p)
+        {
+            if (!_fixed.empty() && _fixed[l])
+                taken[room[l]] = true;
+            else
+                lectures.push_back(l);
+        }
+    for (unsigned int r = 0; r < in.Rooms(); r++)
+        if (!taken[r])
+            rooms.push_back(r);
+    unsigned int n = lectures.size(), m = rooms.size();
+    if (n == 0 || n > m)
+        return;
+
+    // Cost of each lecture in each free room: standing students, plus one if the course does not use the room in other periods
+    vector<vector<int> > a(n + 1, vector<int>(m + 1, 0));
+    for (unsigned int i = 0; i < n; i++)
+    {
+        unsigned int c = course[lectures[i]];
+        vector<bool> used(m, false);
+        for (unsigned int l = first_lecture[c]; l < first_lecture[c] + in.CourseVector(c).Lectures(); l++)
+            if (period[l] != p)
+                used[room[l]] = true;
+        for (unsigned int j = 0; j < m; j++)
+            a[i + 1][j + 1] = max(0, (int) in.CourseVector(c).Students() - (int) in.RoomVector(rooms[j] + 1).Capacity()) * ROOM_CAPACITY_COST +
+                              (used[rooms[j]] ? 0 : ROOM_STABILITY_COST);
+    }
+
+    // Hungarian method (rows are lectures, columns are rooms, n <= m)
+    vector<int> u(n + 1, 0), v(m + 1, 0), way(m + 1, 0);
+    vector<unsigned int> match(m + 1, 0); // lecture (row) assigned to each free room (column)
+    for (unsigned int i = 1; i <= n; i++)
+    {
+        match[0] = i;
+        unsigned int j0 = 0;
+        vector<int> minv(m + 1, INT_MAX);
+        vector<bool> done(m + 1, false);
+        do
+        {
+            done[j0] = true;
+            unsigned int i0 = match[j0], j1 = 0;
+            int delta = INT_MAX;
+            for (unsigned int j = 1; j <= m; j++)
+                if (!done[j])
+                {
+                    int cur = a[i0][j] - u[i0] - v[j];
+                    if (cur < minv[j])
+                    {
+                        minv[j] = cur;
+                        way[j] = j0;
+                    }
+                    if (minv[j] < delta)
+                    {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+            for (unsigned int j = 0; j <= m; j++)
+                if (done[j])
+                {
+                    u[match[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                    minv[j] -= delta;
+            j0 = j1;
+        } while (match[j0] != 0);
+        do
+        {
+            unsigned int j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+    for (unsigned int j = 1; j <= m; j++)
+        if (match[j] != 0)
+            room[lectures[match[j] - 1]] = rooms[j - 1];
+}
+
+void KempeSearch::sort_lectures(vector<unsigned int>& period, vector<unsigned int>& room) const
+{
+    for (unsigned int c = 0; c < in.Courses(); c++)
+    {
+        vector<pair<unsigned int, unsigned int> > lectures;
+        for (unsigned int l = first_lecture[c]; l < first_lecture[c] + in.CourseVector(c).Lectures(); l++)
+            lectures.push_back(make_pair(period[l], room[l]));
+        sort(lectures.begin(), lectures.end());
+        for (unsigned int i = 0; i < lectures.size(); i++)
+        {
+            period[first_lecture[c] + i] = lectures[i].first;
+            room[first_lecture[c] + i] = lectures[i].second;
+        }
+    }
+}
+
+unsigned int KempeSearch::run(vector<unsigned int>& period, vector<unsigned int>& room, unsigned int max_moves)
+{
+    if (course.empty() || in.Periods() < 2)
+        return 0;
+
+    initial_period = period;
+    initial_room = room;
+    int current = cost(period, room);
+    vector<unsigned int> chain;
+
+    for (unsigned int k = 0; k < max_moves; k++)
+    {
+        vector<unsigned int> tentative_period = period, tentative_room = room;
+        unsigned int p, q;
+        if (Random::Int(0, 1))
+        { // Kempe chain of a random lecture
+            unsigned int l = Random::Int(0, course.size() - 1);
+            p = period[l];
+            q = Random::Int(0, in.Periods() - 2);
+            if (q >= p)
+                q++;
+            if (!kempe_chain(l, q, period, chain))
+                continue;
+            for (unsigned int i = 0; i < chain.size(); i++)
+                tentative_period[chain[i]] = period[chain[i]] == p ? q : p;
+        }
+        else
+        { // swap two periods
+            p = Random::Int(0, in.Periods() - 1);
+            q = Random::Int(0, in.Periods() - 2);
+            if (q >= p)
+                q++;
+            bool available = true;
+            for (unsigned int l = 0; l < course.size() && available; l++)
+                if (period[l] == p || period[l] == q)
+                {
+                    tentative_period[l] = period[l] == p ? q : p;
+                    available = in.Available(course[l], tentative_period[l]) && (_fixed.empty() || !_fixed[l]);
+                }
+            if (!available)
+                continue;
+        }
+        // Rooms of p, then of q given the new rooms of p (room stability couples the two periods)
+        assign_rooms(p, tentative_period, tentative_room);
+        assign_rooms(q, tentative_period, tentative_room);
+        // The lectures of a course are in increasing periods, which must not move the fixed ones
+        sort_lectures(tentative_period, tentative_room);
+        if (!in_place(tentative_period, tentative_room))
+            continue;
+        int tentative = cost(tentative_period, tentative_room);
+        if (tentative < current)
+        {
+            period = tentative_period;
+            room = tentative_room;
+            current = tentative;
+        }
+    }
+
+    sort_lectures(period, room);
+    unsigned int changed = 0;
+    for (unsigned int l = 0; l < course.size(); l++)
+        if (period[l] != initial_period[l] || room[l] != initial_room[l])
+            changed++;
+    return changed;
+}
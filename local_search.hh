@@ -0,0 +1,94 @@
+#ifndef CP_CTT_local_search_hh
+#define CP_CTT_local_search_hh
+
+#include "faculty.hh"
+#include <vector>
+
+using namespace std;
+
+/**
+ Local search for CB-CTT with Kempe chain and period swap moves, working
+ directly on the Faculty.
+
+ A Kempe chain move takes a lecture and another period, and swaps the periods
+ of the connected component of the conflict graph (lectures of the same course
+ or of conflicting courses) which contains the lecture and is restricted to
+ the lectures of the two periods. A period swap move exchanges two whole
+ periods. Neither move introduces conflicts, and both are rejected if they
+ place a lecture in an unavailable period or more lectures than rooms in a
+ period, or if they move a fixed lecture.
+
+ After each move the rooms of the two periods are re-optimized per period,
+ sequentially: each period solves an assignment problem (Hungarian method)
+ which minimizes the room capacity cost plus the room stability cost with
+ respect to the rooms used by the courses in the other periods, including
+ the period re-optimized just before. The result is optimal for each period
+ given the other one, not for the two periods jointly. A move is applied if
+ it improves the cost of the timetable (first improvement).
+
+ Lectures are numbered as in the CP model, and the lectures of each course
+ are kept in increasing periods.
+ */
+class KempeSearch
+{
+public:
+
+    /** Constructor
+     *  @param in instance
+     */
+    KempeSearch(const Faculty& in);
+
+    /** Keep the lectures l with fixed[l] in their period and room (e.g., the ones not re-scheduled when re-solving) */
+    void fix(const vector<bool>& fixed);
+
+    /** Add to the cost weight for each lecture which is not in its roomslot of reference (-1 for the lectures without one) */
+    void perturbation(const vector<int>& reference, int weight);
+
+    /** Improve a timetable (period and room of each lecture), trying at most max_moves random moves
+     *  @return the number of lectures whose period or room has changed
+     */
+    unsigned int run(vector<unsigned int>& period, vector<unsigned int>& room, unsigned int max_moves);
+
+    /** Soft cost of a timetable, plus the perturbation if any (same weights as the CP model) */
+    int cost(const vector<unsigned int>& period, const vector<unsigned int>& room) const;
+
+protected:
+
+    /** Kempe chain of lecture l with respect to period q, returns false if it cannot be swapped */
+    bool kempe_chain(unsigned int l, unsigned int q, const vector<unsigned int>& period, vector<unsigned int>& chain) const;
+
+    /** Whether lectures l1 and l2 cannot be in the same period */
+    bool conflict(unsigned int l1, unsigned int l2) const
+    {
+        return course[l1] == course[l2] || in.Conflict(course[l1], course[l2]);
+    }
+
+    /** Re-optimize the rooms of the lectures in period p (the fixed ones keep theirs) */
+    void assign_rooms(unsigned int p, const vector<unsigned int>& period, vector<unsigned int>& room) const;
+
+    /** Whether the fixed lectures are in their period and room at the start of the run */
+    bool in_place(const vector<unsigned int>& period, const vector<unsigned int>& room) const;
+
+    /** Restore increasing periods among the lectures of each course */
+    void sort_lectures(vector<unsigned int>& period, vector<unsigned int>& room) const;
+
+    const Faculty& in;
+
+    /** Course of each lecture */
+    vector<unsigned int> course;
+
+    /** Index of the first lecture of each course */
+    vector<unsigned int> first_lecture;
+
+    /** Lectures which cannot be moved (empty if none) */
+    vector<bool> _fixed;
+
+    /** Period and room of each lecture at the start of the run */
+    vector<unsigned int> initial_period, initial_room;
+
+    /** Roomslots of the perturbed timetable (empty if none) and weight of each lecture moved away from them */
+    vector<int> _reference;
+    int _weight;
+};
+
+#endif
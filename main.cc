@@ -1,6 +1,8 @@
 #include <iostream>
 #include <fstream>
+#include <sys/resource.h>
 #include "CBCTT.hh"
+#include "profile.hh"
 #include "gecode-lns/lns.h"
 
 using namespace std;
@@ -9,28 +11,65 @@ template <typename>
 class LNSCBCTT_ME : public LNS<BAB, LNSCBCTT>
 {
 public:
-  LNSCBCTT_ME(LNSCBCTT* s, const Search::Options& o) : LNS<BAB, LNSCBCTT>(s, o) {}
+  LNSCBCTT_ME(LNSCBCTT* s, const Search::Options& o) : LNS<BAB, LNSCBCTT>(s, o, s->lns_options()) {}
+  
+  ~LNSCBCTT_ME()
+  {
+      // Report the LNS throughput
+      Search::Meta::LNSStatistics s = lns_statistics();
+      cerr << "LNS: " << s.neighbors << " neighbors in " << s.time / 1000.0 << " s ("
+           << s.throughput() << " neighbors/s, batch " << s.batch << ", " << s.threads << " thread(s)), "
+           << s.improvements << " improvements" << endl;
+      if (s.local_searches > 0)
+          cerr << "LNS: " << s.local_searches << " local search runs" << endl;
+      // Report the time to the first (feasible) solution
+      cerr << "LNS: first solution after " << s.first / 1000.0 << " s, first feasible solution after "
+           << s.first_feasible / 1000.0 << " s (negative if none)" << endl;
+      // Report the sub-search strategies chosen by the bandit (if any)
+      for (unsigned int i = 0; i < s.arms.size(); i++)
+          cerr << "LNS: strategy " << s.arms[i].name << ": " << s.arms[i].pulls << " neighbors, "
+               << s.arms[i].improvement << " improvement in " << s.arms[i].time / 1000.0 << " s, "
+               << s.arms[i].mean() << " mean reward (improvement/ms)" << endl;
+      // Report the memory footprint (to spot leaks in long runs)
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+      double rss = usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+      double rss = usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+      cerr << "LNS: " << s.clones << " spaces cloned, peak RSS " << rss << " MB" << endl;
+      // Report where the time went (only if compiled with -DLNS_PROFILE)
+      if (Search::Meta::LNSProfile::enabled())
+          Search::Meta::LNSProfile::total().print(cerr);
+  }
 };
 
 int main(int argc, char * argv[])
 {
     // Read options
-    LNSInstanceOptions opt("");
+    CBCTTOptions opt("");
     opt.model(0, "debug", "debug model (print lots of stuff)");
     opt.model(1, "experiments", "silent model only prints a solution in the end"); // default
     opt.model(0);
     
     opt.parse(argc, argv);
-  
-  
-    // The lns options (FIXME: to remove)
-    Gecode::Search::Meta::LNS::lns_options = &opt;
+    
+    // Seed the random numbers generator of the main thread (engines derive their own streams from the same seed)
+    Random::Seed(opt.seed());
 
     try
     {
         cerr << opt.minIntensity() << endl;
+
+        // Profile the propagation of the families of constraints instead of solving
+        if (opt.propagationProfile() > 0)
+        {
+            PropagationProfile(opt, opt.propagationProfile()).run(cerr);
+            return 0;
+        }
       
-        Script::run<LNSCBCTT, LNSCBCTT_ME, LNSInstanceOptions>(opt);
+        Script::run<LNSCBCTT, LNSCBCTT_ME, CBCTTOptions>(opt);
         //Script::run<InstantBranchingSpace<CBCTT>, BAB, InstanceOptions>(opt);
     }
     catch(std::exception e)
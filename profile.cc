@@ -0,0 +1,122 @@
+#include "profile.hh"
+#include "construction.hh"
+#include "solution.hh"
+#include "random.hh"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+/** Names of the families of constraints (as in ConstraintFamily) */
+static const char* family_names[FAMILIES] = {
+    "channeling", "duplicates", "ordering", "conflicts", "conflicting_lectures",
+    "availability", "capacity", "stability", "working_days", "compactness"
+};
+
+PropagationProfile::PropagationProfile(const CBCTTOptions& o, unsigned int neighbors) : options(o)
+{
+    // The full model loads the instance
+    CBCTT full(o);
+    propagators = full.family_propagators;
+    const Faculty& in = CBCTT::in;
+
+    // Timetable from the solution file (if any), completed by the construction
+    Construction construction(in);
+    timetable = construction.build(o.tabuIterations());
+    if (o.init() != NULL)
+    {
+        vector<int> init = read_solution(in, o.init());
+        for (unsigned int l = 0; l < init.size(); l++)
+            if (init[l] >= 0)
+                timetable[l] = init[l];
+    }
+
+    // Relaxations as large as the LNS ones
+    unsigned int lectures = timetable.size();
+    unsigned int min_relaxed = o.minIntensity(), max_relaxed = o.maxIntensity();
+    if (o.minIntensityRatio() > 0.0)
+        min_relaxed = max(1u, (unsigned int) ceil(o.minIntensityRatio() * lectures));
+    if (o.maxIntensityRatio() > 0.0)
+        max_relaxed = max(1u, (unsigned int) ceil(o.maxIntensityRatio() * lectures));
+    min_relaxed = min(min_relaxed, lectures);
+    max_relaxed = min(max(min_relaxed, max_relaxed), lectures);
+
+    vector<unsigned int> order(lectures);
+    for (unsigned int l = 0; l < lectures; l++)
+        order[l] = l;
+    for (unsigned int n = 0; n < neighbors; n++)
+    {
+        Random::Shuffle(order.begin(), order.end());
+        unsigned int relaxed = Random::Int(min_relaxed, max_relaxed);
+        fixed_lectures.push_back(vector<unsigned int>(order.begin() + relaxed, order.end()));
+    }
+}
+
+void PropagationProfile::replay(unsigned int omitted, double& time, unsigned long int& propagations, unsigned int& failed) const
+{
+    time = 0;
+    propagations = 0;
+    failed = 0;
+
+    CBCTT root(options, omitted);
+    if (root.status() == SS_FAILED)
+    {
+        failed = fixed_lectures.size();
+        return;
+    }
+    for (unsigned int n = 0; n < fixed_lectures.size(); n++)
+    {
+        CBCTT* s = static_cast<CBCTT*>(root.clone());
+        for (unsigned int i = 0; i < fixed_lectures[n].size(); i++)
+            rel(*s, s->roomslot[fixed_lectures[n][i]] == timetable[fixed_lectures[n][i]]);
+        StatusStatistics stat;
+        auto start = chrono::steady_clock::now();
+        if (s->status(stat) == SS_FAILED)
+            failed++;
+        time += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        propagations += stat.propagate;
+        delete s;
+    }
+}
+
+void PropagationProfile::run(ostream& os)
+{
+    double time, full_time;
+    unsigned long int propagations, full_propagations;
+    unsigned int failed, full_failed;
+
+    // Warm up, then the full model
+    replay(0, full_time, full_propagations, full_failed);
+    replay(0, full_time, full_propagations, full_failed);
+
+    os << "Propagation profile: " << fixed_lectures.size() << " neighbors, " << full_propagations << " propagations in "
+       << full_time << " ms, " << full_failed << " failed" << endl;
+    os << left << setw(22) << "family" << right << setw(12) << "propagators" << setw(16) << "propagations"
+       << setw(12) << "time (ms)" << setw(9) << "share" << setw(9) << "failed" << endl;
+
+    // Marginal cost of each family (the channeling is needed by all the others)
+    vector<double> marginal(FAMILIES, 0);
+    for (unsigned int f = 0; f < FAMILIES; f++)
+    {
+        os << left << setw(22) << family_names[f] << right << setw(12) << propagators[f];
+        if (f == FAMILY_CHANNELING)
+        {
+            os << setw(16) << "-" << setw(12) << "-" << setw(9) << "-" << setw(9) << "-" << endl;
+            continue;
+        }
+        replay(1u << f, time, propagations, failed);
+        marginal[f] = full_time - time;
+        os << setw(16) << (long int) (full_propagations - propagations) << setw(12) << fixed << setprecision(2) << marginal[f]
+           << setw(8) << setprecision(1) << (full_time > 0 ? 100 * marginal[f] / full_time : 0) << "%"
+           << setw(9) << (int) full_failed - (int) failed << defaultfloat << setprecision(6) << endl;
+    }
+
+    // Dominant family, and dominant cost component
+    unsigned int dominant = FAMILY_DUPLICATES, component = FAMILY_CAPACITY;
+    for (unsigned int f = FAMILY_DUPLICATES; f < FAMILIES; f++)
+        if (marginal[f] > marginal[dominant])
+            dominant = f;
+    for (unsigned int f = FAMILY_CAPACITY; f <= FAMILY_COMPACTNESS; f++)
+        if (marginal[f] > marginal[component])
+            component = f;
+    os << "Dominant family: " << family_names[dominant] << ", dominant cost component: " << family_names[component] << endl;
+}
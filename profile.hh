@@ -0,0 +1,59 @@
+#ifndef CP_CTT_profile_hh
+#define CP_CTT_profile_hh
+
+#include "CBCTT.hh"
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+/**
+ Profile of the propagation cost of each family of constraints of the model.
+
+ Gecode does not attribute propagator executions to the constraints which posted
+ them, hence the cost of each family is measured by ablation: a set of neighbors
+ (the lectures of a timetable fixed to their roomslots, except a random subset as
+ large as the LNS relaxations) is propagated by the full model, and then again by
+ the model without the family. The differences in propagator executions and time
+ are the marginal cost of the family, which is reported with the number of
+ propagators the family posts in the root space.
+
+ The same neighbors are replayed for every model, so that the measures are
+ comparable, and a first (discarded) replay warms up the caches.
+ */
+class PropagationProfile
+{
+public:
+
+    /** Constructor, loads the instance, builds a timetable and draws the neighbors
+     *  @param o options of the solver (instance, construction, LNS intensities)
+     *  @param neighbors number of neighbors to be propagated by each model
+     */
+    PropagationProfile(const CBCTTOptions& o, unsigned int neighbors);
+
+    /** Replay the neighbors on the full model and on the model without each family, print the profile */
+    void run(ostream& os);
+
+protected:
+
+    /** Propagation of the neighbors by a model
+     *  @param omitted families of constraints not posted (a bit for each ConstraintFamily)
+     *  @param time total propagation time (ms)
+     *  @param propagations total propagator executions
+     *  @param failed number of neighbors which failed
+     */
+    void replay(unsigned int omitted, double& time, unsigned long int& propagations, unsigned int& failed) const;
+
+    const CBCTTOptions& options;
+
+    /** Roomslot of each lecture in the timetable */
+    vector<int> timetable;
+
+    /** Lectures fixed in each neighbor */
+    vector<vector<unsigned int> > fixed_lectures;
+
+    /** Propagators posted by each family (in the full model) */
+    vector<unsigned int> propagators;
+};
+
+#endif
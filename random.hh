@@ -1,19 +1,46 @@
 #ifndef CP_CTT_random_hh
 #define CP_CTT_random_hh
 
-#include <random>
+#include <stdint.h>
+#include <iterator>
+#include <algorithm>
 
-/** A class to generate random numbers with Mersenne Twister */
+/**
+ A fast, splittable random number generator (SplitMix64).
+ 
+ Every thread has its own generator state, hence there is no contention 
+ and no synchronization among threads. Runs are reproducible: the state
+ of each thread is derived from a seed and a stream index, and search
+ engines that move across threads carry their own state along (see Scope).
+ */
 class Random
 {
 public:
     
-    /** Mersenne Twister engine */
-    static std::mt19937 g;
+    /** State of a generator */
+    typedef uint64_t State;
     
-    /** Randomness generating device */
-    static std::random_device dev;
+    /** State of the generator of the calling thread */
+    static State& state()
+    {
+        static thread_local State s = Stream(0, 0);
+        return s;
+    }
     
+    /** Returns the state of the independent stream of random numbers number <stream> for <seed>
+     @param seed seed of the run
+     @param stream index of the stream (e.g., of a parallel worker)
+     */
+    static State Stream(unsigned int seed, unsigned int stream)
+    {
+        return Mix(Mix(seed) ^ (0x9E3779B97F4A7C15ULL * (stream + 1ULL)));
+    }
+    
+    /** Generates an uniform random 64 bits integer */
+    static uint64_t Next()
+    {
+        return Mix(state() += 0x9E3779B97F4A7C15ULL);
+    }
     
     /** Generates an uniform random integer in [a,b].
      @param a lower bound
@@ -21,30 +48,74 @@ public:
      */
     static unsigned int Int(unsigned int a, unsigned int b)
     {
-        std::uniform_int_distribution<> d(a,b);
-        return d(g);
+        uint64_t range = (uint64_t)b - a + 1, x;
+        // Reject the values that would bias the modulo
+        uint64_t limit = UINT64_MAX - UINT64_MAX % range;
+        do
+            x = Next();
+        while (x >= limit);
+        return a + (unsigned int)(x % range);
     }
     
-    /** Generates an uniform random double in [a,b]
+    /** Generates an uniform random double in [a,b)
      @param a lower bound
      @param b upper bound
-     @remarks generates an uniform random double in [0,1] if called without arguments
+     @remarks generates an uniform random double in [0,1) if called without arguments
      */
     static double Double(double a = 0, double b = 1)
     {
-        std::uniform_real_distribution<> d(a,b);
-        return d(g);
+        return a + (b - a) * ((Next() >> 11) * (1.0 / 9007199254740992.0));
     }
     
-    /** Sets a new seed for the random engine. */
+    /** Randomly permutes the elements in [first,last) */
+    template <class RandomIt>
+    static void Shuffle(RandomIt first, RandomIt last)
+    {
+        typename std::iterator_traits<RandomIt>::difference_type n = last - first;
+        for (; n > 1; n--)
+            std::iter_swap(first + (n - 1), first + Int(0, n - 1));
+    }
+    
+    /** Sets a new seed for the random engine of the calling thread. */
     static void Seed(unsigned int seed)
     {
-        g.seed(seed);
-        Random::seed = seed;
+        state() = Stream(seed, 0);
     }
     
-    /** Seed */
-    static unsigned int seed;
+    /**
+     Installs the generator state <s> in the calling thread for the lifetime
+     of the object, then stores the advanced state back into <s> and 
+     restores the previous state of the thread.
+     */
+    class Scope
+    {
+    public:
+        Scope(State& s) : s(s), saved(state())
+        {
+            state() = s;
+        }
+        
+        ~Scope()
+        {
+            s = state();
+            state() = saved;
+        }
+        
+    protected:
+        
+        State& s;
+        State saved;
+    };
+    
+protected:
+    
+    /** SplitMix64 finalizer */
+    static uint64_t Mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
 };
 
 class State;
@@ -0,0 +1,121 @@
+#include "solution.hh"
+#include <algorithm>
+#include <stdexcept>
+#include <climits>
+
+vector<int> read_solution(const Faculty& in, const char* file)
+{
+    ifstream is(file);
+    if (!is)
+        throw std::logic_error(string("Could not open solution file ") + file);
+    
+    // Roomslots of each course, as they come
+    vector<vector<int> > course_roomslots(in.Courses());
+    string course_name, room_name;
+    int day, timeslot, skipped = 0;
+    while (is >> course_name >> room_name >> day >> timeslot)
+    {
+        int c = in.CourseIndex(course_name), r = in.RoomIndex(room_name);
+        if (c < 0 || day < 0 || day >= (int) in.Days() || timeslot < 0 || timeslot >= (int) in.PeriodsPerDay())
+        {
+            skipped++;
+            continue;
+        }
+        if (r < 1 || r > (int) in.Rooms())
+            r = 1;
+        course_roomslots[c].push_back((day * in.PeriodsPerDay() + timeslot) * in.Rooms() + r - 1);
+    }
+    
+    // Lectures of the same course in increasing periods (symmetry breaking of the model), extra ones are ignored
+    vector<int> roomslot(in.TotalLectures(), -1);
+    int read = 0;
+    for (unsigned int c = 0, l = 0; c < in.Courses(); l += in.CourseVector(c).Lectures(), c++)
+    {
+        sort(course_roomslots[c].begin(), course_roomslots[c].end());
+        for (unsigned int i = 0; i < course_roomslots[c].size() && i < in.CourseVector(c).Lectures(); i++, read++)
+            roomslot[l + i] = course_roomslots[c][i];
+    }
+    cerr << "Solution " << file << ": " << read << " of " << in.TotalLectures() << " lectures read";
+    if (skipped > 0)
+        cerr << " (" << skipped << " invalid lines skipped)";
+    cerr << endl;
+    return roomslot;
+}
+
+Perturbation::Perturbation(const Faculty& old_in, const char* old_solution, const Faculty& in, unsigned int radius) : _invalidated(0)
+{
+    vector<int> old = read_solution(old_in, old_solution);
+    
+    vector<unsigned int> old_first(old_in.Courses());
+    for (unsigned int c = 0, l = 0; c < old_in.Courses(); l += old_in.CourseVector(c).Lectures(), c++)
+        old_first[c] = l;
+    
+    // Map the old roomslots onto the new instance
+    unsigned int lectures = in.TotalLectures();
+    vector<unsigned int> course(lectures);
+    vector<bool> invalid(lectures, false);
+    old_roomslot.assign(lectures, -1);
+    for (unsigned int c = 0, l = 0; c < in.Courses(); c++)
+    {
+        int oc = old_in.CourseIndex(in.CourseVector(c).Name());
+        for (unsigned int i = 0; i < in.CourseVector(c).Lectures(); i++, l++)
+        {
+            course[l] = c;
+            invalid[l] = true;
+            if (oc < 0 || i >= old_in.CourseVector(oc).Lectures() || old[old_first[oc] + i] < 0)
+                continue;
+            int op = old[old_first[oc] + i] / old_in.Rooms(), orm = old[old_first[oc] + i] % old_in.Rooms();
+            unsigned int day = op / old_in.PeriodsPerDay(), timeslot = op % old_in.PeriodsPerDay();
+            if (day >= in.Days() || timeslot >= in.PeriodsPerDay())
+                continue;
+            unsigned int p = day * in.PeriodsPerDay() + timeslot;
+            int r = in.RoomIndex(old_in.RoomVector(orm + 1).Name());
+            if (r < 1 || r > (int) in.Rooms())
+            { // the room is gone, the period is kept as a hint
+                old_roomslot[l] = p * in.Rooms();
+                continue;
+            }
+            old_roomslot[l] = p * in.Rooms() + r - 1;
+            invalid[l] = !in.Available(c, p);
+        }
+    }
+    
+    // Conflicts and overlaps in the new instance
+    for (unsigned int l1 = 0; l1 < lectures; l1++)
+        for (unsigned int l2 = l1 + 1; l2 < lectures; l2++)
+        {
+            if (old_roomslot[l1] < 0 || old_roomslot[l2] < 0)
+                continue;
+            bool same_period = old_roomslot[l1] / in.Rooms() == old_roomslot[l2] / in.Rooms();
+            if (old_roomslot[l1] == old_roomslot[l2] ||
+                (same_period && (course[l1] == course[l2] || in.Conflict(course[l1], course[l2]))))
+                invalid[l1] = invalid[l2] = true;
+        }
+    
+    // Free the courses with invalidated lectures, then the courses in conflict with them up to the given radius
+    vector<unsigned int> distance(in.Courses(), UINT_MAX);
+    vector<unsigned int> frontier;
+    for (unsigned int l = 0; l < lectures; l++)
+        if (invalid[l])
+        {
+            _invalidated++;
+            if (distance[course[l]] != 0)
+                frontier.push_back(course[l]);
+            distance[course[l]] = 0;
+        }
+    for (unsigned int head = 0; head < frontier.size(); head++)
+    {
+        unsigned int c = frontier[head];
+        if (distance[c] >= radius)
+            continue;
+        for (unsigned int a = 0; a < in.CourseConflicts(c); a++)
+            if (distance[in.CourseConflict(c, a)] == UINT_MAX)
+            {
+                distance[in.CourseConflict(c, a)] = distance[c] + 1;
+                frontier.push_back(in.CourseConflict(c, a));
+            }
+    }
+    _freed.resize(lectures);
+    for (unsigned int l = 0; l < lectures; l++)
+        _freed[l] = distance[course[l]] != UINT_MAX;
+}
@@ -0,0 +1,69 @@
+#ifndef CP_CTT_solution_hh
+#define CP_CTT_solution_hh
+
+#include "faculty.hh"
+#include <vector>
+
+using namespace std;
+
+/** 
+ Read a solution file for an instance (one "course room day period" line per lecture, in any 
+ order), returns the roomslot (period * rooms + room) of each lecture, numbered as in the CP 
+ model, or -1 for the lectures missing from the file. Lines with unknown courses or out of 
+ range periods are skipped, lectures in unknown rooms are placed in the first room of their 
+ period, and the lectures of each course are in increasing periods.
+ */
+vector<int> read_solution(const Faculty& in, const char* file);
+
+/**
+ Mapping of an old timetable onto an edited instance, for minimal perturbation re-solving.
+
+ Lectures are mapped by course name (the i-th lecture of a course in the old timetable is
+ the i-th lecture of the course in the new instance), periods by day and timeslot, rooms
+ by name. A lecture is invalidated by the edit if it has no old roomslot (e.g., the course
+ is new), if its room or period does not exist anymore, if its course is not available in
+ its period anymore, or if it is in conflict or overlaps with another lecture in the new
+ instance.
+
+ The lectures to be re-scheduled are those of the courses with invalidated lectures, and
+ of the courses within a given distance from them in the conflict graph of the courses, all
+ the others keep their old roomslot.
+ */
+class Perturbation
+{
+public:
+
+    /** Constructor
+     *  @param old_in old instance
+     *  @param old_solution old timetable (solution file of the old instance)
+     *  @param in new instance
+     *  @param radius distance from the courses with invalidated lectures within which courses are re-scheduled
+     */
+    Perturbation(const Faculty& old_in, const char* old_solution, const Faculty& in, unsigned int radius);
+
+    /** Old roomslot of each lecture of the new instance (-1 if none) */
+    const vector<int>& roomslots() const
+    {
+        return old_roomslot;
+    }
+
+    /** Whether each lecture of the new instance has to be re-scheduled */
+    const vector<bool>& freed() const
+    {
+        return _freed;
+    }
+
+    /** Number of lectures invalidated by the edit */
+    unsigned int invalidated() const
+    {
+        return _invalidated;
+    }
+
+protected:
+
+    vector<int> old_roomslot;
+    vector<bool> _freed;
+    unsigned int _invalidated;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "solver.hh"
+#include <chrono>
+#include <mutex>
+
+/** Stop criterion of the search: cancellation (by the callback or by the caller) or time limit */
+class CancellationStop : public Search::Stop
+{
+public:
+
+    CancellationStop(const CBCTTCancellation* c, unsigned long int time) : cancellation(c), ts(time > 0 ? new Search::TimeStop(time) : NULL) {}
+
+    ~CancellationStop()
+    {
+        delete ts;
+    }
+
+    /** Stop the search (without touching the cancellation of the caller) */
+    void cancel()
+    {
+        own.cancel();
+    }
+
+    virtual bool stop(const Search::Statistics& s, const Search::Options& o)
+    {
+        return own.cancelled() || (cancellation != NULL && cancellation->cancelled()) || (ts != NULL && ts->stop(s, o));
+    }
+
+protected:
+
+    CBCTTCancellation own;
+    const CBCTTCancellation* cancellation;
+    Search::TimeStop* ts;
+};
+
+/** Timetable and cost breakdown of a solution of the model */
+static void record(const LNSCBCTT& s, CBCTTSolution& solution)
+{
+    const Faculty& in = CBCTT::in;
+    solution.roomslots.resize(s.roomslot.size());
+    for (unsigned int c = 0, l = 0; c < in.Courses(); c++)
+        for (unsigned int i = 0; i < in.CourseVector(c).Lectures(); i++, l++)
+        {
+            solution.roomslots[l] = s.roomslot[l].val();
+            solution.timetable(c, solution.roomslots[l] / in.Rooms()) = solution.roomslots[l] % in.Rooms() + 1;
+        }
+    solution.cost.total = s.cost().val();
+    solution.cost.conflicts = s.cost_component(0);
+    solution.cost.overlaps = s.cost_component(1);
+    solution.cost.room_capacity = s.cost_component(2);
+    solution.cost.room_stability = s.cost_component(3);
+    solution.cost.min_working_days = s.cost_component(4);
+    solution.cost.curriculum_compactness = s.cost_component(5);
+}
+
+CBCTTSolution solve(const Faculty& in, const CBCTTOptions& options, const CBCTTCallback& callback, CBCTTCancellation* cancellation)
+{
+    static mutex solving;
+    lock_guard<mutex> lock(solving);
+
+    auto start = chrono::steady_clock::now();
+    // The run is seeded as the solver executable, and the generator of the caller is restored on return
+    Random::State rng = Random::Stream(options.seed(), 0);
+    Random::Scope scope(rng);
+    CancellationStop stop(cancellation, options.time());
+    Search::Options so;
+    so.stop = &stop;
+
+    CBCTTSolution best(in);
+    LNSCBCTT* root = new LNSCBCTT(options, &in);
+    {
+        LNS<BAB, LNSCBCTT> e(root, so, root->lns_options());
+        while (LNSCBCTT* s = e.next())
+        {
+            CBCTTSolution current(in);
+            record(*s, current);
+            current.time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            delete s;
+            best = current;
+            if (callback && !callback(best))
+                stop.cancel();
+        }
+    }
+    delete root;
+    return best;
+}
@@ -0,0 +1,96 @@
+#ifndef CP_CTT_solver_hh
+#define CP_CTT_solver_hh
+
+#include "CBCTT.hh"
+#include <vector>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+/** Cost of a timetable, broken down into its components (unweighted, as in the CP model) */
+struct CBCTTCost
+{
+    CBCTTCost() : total(-1), conflicts(0), overlaps(0), room_capacity(0), room_stability(0), min_working_days(0), curriculum_compactness(0) {}
+
+    /** Weighted sum of the soft components (plus the perturbation, when re-solving), -1 if there is no timetable */
+    int total;
+
+    /** Lectures of conflicting courses in the same period, and lectures in the same roomslot (hard) */
+    int conflicts, overlaps;
+
+    int room_capacity, room_stability, min_working_days, curriculum_compactness;
+};
+
+/** A timetable found by the solver */
+struct CBCTTSolution
+{
+    CBCTTSolution(const Faculty& in) : timetable(in), time(0) {}
+
+    /** Whether a timetable has been found */
+    bool found() const
+    {
+        return !roomslots.empty();
+    }
+
+    /** Whether the timetable satisfies the hard constraints */
+    bool feasible() const
+    {
+        return found() && cost.conflicts == 0 && cost.overlaps == 0;
+    }
+
+    /** Room (plus one, zero if none) of each course in each period */
+    Timetable timetable;
+
+    /** Roomslot (period * rooms + room) of each lecture, numbered as in the CP model */
+    vector<int> roomslots;
+
+    CBCTTCost cost;
+
+    /** Seconds since the start of the search */
+    double time;
+};
+
+/** Cancellation of a search, which can be requested from any thread */
+class CBCTTCancellation
+{
+public:
+
+    CBCTTCancellation() : requested(false) {}
+
+    /** Request the search to stop (it returns the best timetable found so far) */
+    void cancel()
+    {
+        requested = true;
+    }
+
+    bool cancelled() const
+    {
+        return requested;
+    }
+
+protected:
+
+    atomic<bool> requested;
+};
+
+/** Called with each improving timetable, as soon as it is found; returning false stops the search */
+typedef function<bool(const CBCTTSolution&)> CBCTTCallback;
+
+/**
+ Solve an instance in-process, i.e., without the Gecode Script driver, and return the
+ best timetable found.
+
+ The search is the same as the one of the solver executable, with the given options
+ (except the instance, which is the given one), and stops when the time limit of the
+ options (-time, in milliseconds) is reached, when the search space is exhausted, or
+ when it is cancelled (by the callback or by a cancellation). The options must outlive
+ the call, and the instance must outlive the returned timetable.
+
+ The model keeps the instance in a static member, hence calls from different threads
+ are serialized. The call neither changes the random generator of the calling thread
+ nor cancels the given cancellation (when the callback stops the search).
+ */
+CBCTTSolution solve(const Faculty& in, const CBCTTOptions& options, const CBCTTCallback& callback = CBCTTCallback(), CBCTTCancellation* cancellation = NULL);
+
+#endif